@@ -48,6 +48,9 @@ namespace {
 
 constexpr auto kChannelGetDifferenceLimit = 100;
 
+// How many getChannelDifference requests can be sent at the same time.
+constexpr auto kChannelGetDifferenceRequestsLimit = 16;
+
 // 1s wait after show channel history before sending getChannelDifference.
 constexpr auto kWaitForChannelGetDifference = crl::time(1000);
 
@@ -57,6 +60,11 @@ constexpr auto kNoUpdatesTimeout = 60 * 1000;
 // If nothing is received in 1 min when was a sleepmode we ping.
 constexpr auto kNoUpdatesAfterSleepTimeout = 60 * crl::time(1000);
 
+// Users, chats and messages of a difference are applied by such parts,
+// yielding to the event loop after kDifferenceChunksDuration.
+constexpr auto kDifferenceChunkSize = 50;
+constexpr auto kDifferenceChunksDuration = crl::time(8);
+
 enum class DataIsLoadedResult {
 	NotLoaded = 0,
 	FromNotLoaded = 1,
@@ -205,6 +213,18 @@ DataIsLoadedResult AllDataLoadedForMessage(
 	});
 }
 
+template <typename Type>
+[[nodiscard]] std::vector<MTPVector<Type>> SplitToChunks(
+		const MTPVector<Type> &list) {
+	auto result = std::vector<MTPVector<Type>>();
+	const auto size = list.v.size();
+	result.reserve((size + kDifferenceChunkSize - 1) / kDifferenceChunkSize);
+	for (auto i = 0; i < size; i += kDifferenceChunkSize) {
+		result.push_back(MTP_vector<Type>(list.v.mid(i, kDifferenceChunkSize)));
+	}
+	return result;
+}
+
 } // namespace
 
 Updates::Updates(not_null<Main::Session*> session)
@@ -216,6 +236,7 @@ Updates::Updates(not_null<Main::Session*> session)
 , _bySeqTimer([=] { getDifference(); })
 , _byMinChannelTimer([=] { getDifference(); })
 , _failDifferenceTimer([=] { getDifferenceAfterFail(); })
+, _differenceChunksTimer([=] { applyDifferenceChunks(); })
 , _idleFinishTimer([=] { checkIdleFinish(); }) {
 	_ptsWaiter.setRequesting(true);
 
@@ -455,23 +476,25 @@ void Updates::differenceDone(const MTPupdates_Difference &result) {
 	} break;
 	case mtpc_updates_differenceSlice: {
 		auto &d = result.c_updates_differenceSlice();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		auto &s = d.vintermediate_state().c_updates_state();
-		setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
+		const auto state = d.vintermediate_state();
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=] {
+			auto &s = state.c_updates_state();
+			setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
 
-		_ptsWaiter.setRequesting(false);
+			_ptsWaiter.setRequesting(false);
 
-		MTP_LOG(0, ("getDifference "
-			"{ good - after a slice of difference was received }%1"
-			).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
-		getDifference();
+			MTP_LOG(0, ("getDifference "
+				"{ good - after a slice of difference was received }%1"
+				).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
+			getDifference();
+		});
 	} break;
 	case mtpc_updates_difference: {
 		auto &d = result.c_updates_difference();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		stateDone(d.vstate());
+		const auto state = d.vstate();
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=] {
+			stateDone(state);
+		});
 	} break;
 	case mtpc_updates_differenceTooLong: {
 		LOG(("API Error: updates.differenceTooLong is not supported by Telegram Desktop!"));
@@ -568,13 +591,70 @@ void Updates::feedDifference(
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other) {
+		const MTPVector<MTPUpdate> &other,
+		FnMut<void()> done) {
 	Core::App().checkAutoLock();
-	session().data().processUsers(users);
-	session().data().processChats(chats);
-	feedMessageIds(other);
-	session().data().processMessages(msgs, NewMessageType::Unread);
-	feedUpdateVector(other, SkipUpdatePolicy::SkipMessageIds);
+	const auto count = users.v.size() + chats.v.size() + msgs.v.size();
+	const auto applying = !_differenceChunks.empty();
+	if (count <= kDifferenceChunkSize && !applying) {
+		session().data().processUsers(users);
+		session().data().processChats(chats);
+		feedMessageIds(other);
+		session().data().processMessages(msgs, NewMessageType::Unread);
+		feedUpdateVector(other, SkipUpdatePolicy::SkipMessageIds);
+		done();
+		return;
+	}
+	DEBUG_LOG(("Updates Info: applying difference by parts, "
+		"%1 users, %2 chats, %3 messages, %4 other updates."
+		).arg(users.v.size()
+		).arg(chats.v.size()
+		).arg(msgs.v.size()
+		).arg(other.v.size()));
+
+	// Users and chats go first, so that messages could reference them.
+	for (const auto &chunk : SplitToChunks(users)) {
+		_differenceChunks.push_back([=] {
+			session().data().processUsers(chunk);
+		});
+	}
+	for (const auto &chunk : SplitToChunks(chats)) {
+		_differenceChunks.push_back([=] {
+			session().data().processChats(chunk);
+		});
+	}
+	_differenceChunks.push_back([=] {
+		feedMessageIds(other);
+	});
+	for (const auto &chunk : SplitToChunks(msgs)) {
+		_differenceChunks.push_back([=] {
+			session().data().processMessages(chunk, NewMessageType::Unread);
+			session().data().sendHistoryChangeNotifications();
+		});
+	}
+	_differenceChunks.push_back([=] {
+		feedUpdateVector(other, SkipUpdatePolicy::SkipMessageIds);
+	});
+	_differenceChunks.push_back(std::move(done));
+
+	_catchingUp = true;
+	if (!applying) {
+		applyDifferenceChunks();
+	}
+}
+
+void Updates::applyDifferenceChunks() {
+	const auto till = crl::now() + kDifferenceChunksDuration;
+	while (!_differenceChunks.empty()) {
+		auto chunk = std::move(_differenceChunks.front());
+		_differenceChunks.pop_front();
+		chunk();
+		if (!_differenceChunks.empty() && crl::now() >= till) {
+			_differenceChunksTimer.callOnce(0);
+			return;
+		}
+	}
+	_catchingUp = false;
 }
 
 void Updates::differenceFail(const MTP::Error &error) {
@@ -682,6 +762,28 @@ void Updates::getChannelDifference(
 		_whenGetDiffAfterFail.remove(channel);
 	}
 
+	if (_channelDifferenceRequests >= kChannelGetDifferenceRequestsLimit) {
+		const auto i = _channelDifferenceQueue.find(channel);
+		if (i == end(_channelDifferenceQueue)) {
+			_channelDifferenceQueue.emplace(
+				channel,
+				QueuedChannelDifference{
+					from,
+					++_channelDifferenceQueueOrder,
+				});
+		} else if (i->second.from != ChannelDifferenceRequest::PtsGapOrShortPoll) {
+			i->second.from = from;
+		}
+		return;
+	}
+	sendChannelDifference(channel, from);
+}
+
+void Updates::sendChannelDifference(
+		not_null<ChannelData*> channel,
+		ChannelDifferenceRequest from) {
+	_channelDifferenceQueue.remove(channel);
+	++_channelDifferenceRequests;
 	channel->ptsSetRequesting(true);
 
 	auto filter = MTP_channelMessagesFilterEmpty();
@@ -698,12 +800,56 @@ void Updates::getChannelDifference(
 		MTP_int(channel->pts()),
 		MTP_int(kChannelGetDifferenceLimit)
 	)).done([=](const MTPupdates_ChannelDifference &result) {
+		--_channelDifferenceRequests;
 		channelDifferenceDone(channel, result);
+		sendQueuedChannelDifferences();
 	}).fail([=](const MTP::Error &error) {
+		--_channelDifferenceRequests;
 		channelDifferenceFail(channel, error);
+		sendQueuedChannelDifferences();
 	}).send();
 }
 
+void Updates::sendQueuedChannelDifferences() {
+	while (!_channelDifferenceQueue.empty()
+		&& _channelDifferenceRequests < kChannelGetDifferenceRequestsLimit) {
+		const auto i = ranges::max_element(
+			_channelDifferenceQueue,
+			std::less<>(),
+			[&](const auto &pair) {
+				return std::make_pair(
+					channelDifferencePriority(pair.first),
+					-pair.second.order);
+			});
+		const auto channel = i->first;
+		const auto from = i->second.from;
+		_channelDifferenceQueue.erase(i);
+		if (channel->ptsInited() && !channel->ptsRequesting()) {
+			sendChannelDifference(channel, from);
+		}
+	}
+}
+
+int Updates::channelDifferencePriority(
+		not_null<ChannelData*> channel) const {
+	const auto active = ranges::contains(
+		_activeChats,
+		channel.get(),
+		[](const auto &pair) { return pair.second.peer; });
+	if (active) {
+		return 3;
+	}
+	const auto history = channel->owner().historyLoaded(channel);
+	if (!history) {
+		return 0;
+	} else if (history->hasUnreadMentions()) {
+		return 2;
+	} else if (history->isPinnedDialog(FilterId())) {
+		return 1;
+	}
+	return 0;
+}
+
 void Updates::sendPing() {
 	_session->mtp().ping();
 }
@@ -873,6 +1019,14 @@ rpl::producer<bool> Updates::isIdleValue() const {
 	return _isIdle.value();
 }
 
+bool Updates::catchingUp() const {
+	return _catchingUp.current();
+}
+
+rpl::producer<bool> Updates::catchingUpValue() const {
+	return _catchingUp.value();
+}
+
 void Updates::updateOnline(crl::time lastNonIdleTime, bool gotOtherOffline) {
 	if (!lastNonIdleTime) {
 		lastNonIdleTime = Core::App().lastNonIdleTime();
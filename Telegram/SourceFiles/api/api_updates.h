@@ -41,6 +41,8 @@ public:
 	void updateOnline(crl::time lastNonIdleTime = 0);
 	[[nodiscard]] bool isIdle() const;
 	[[nodiscard]] rpl::producer<bool> isIdleValue() const;
+	[[nodiscard]] bool catchingUp() const;
+	[[nodiscard]] rpl::producer<bool> catchingUpValue() const;
 	void checkIdleFinish(crl::time lastNonIdleTime = 0);
 	bool lastWasOnline() const;
 	crl::time lastSetOnline() const;
@@ -78,6 +80,11 @@ private:
 		rpl::lifetime lifetime;
 	};
 
+	struct QueuedChannelDifference {
+		ChannelDifferenceRequest from = ChannelDifferenceRequest::Unknown;
+		int order = 0;
+	};
+
 	void channelRangeDifferenceSend(
 		not_null<ChannelData*> channel,
 		MsgRange range,
@@ -98,13 +105,21 @@ private:
 	void getChannelDifference(
 		not_null<ChannelData*> channel,
 		ChannelDifferenceRequest from = ChannelDifferenceRequest::Unknown);
+	void sendChannelDifference(
+		not_null<ChannelData*> channel,
+		ChannelDifferenceRequest from);
+	void sendQueuedChannelDifferences();
+	[[nodiscard]] int channelDifferencePriority(
+		not_null<ChannelData*> channel) const;
 	void differenceDone(const MTPupdates_Difference &result);
 	void differenceFail(const MTP::Error &error);
 	void feedDifference(
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other);
+		const MTPVector<MTPUpdate> &other,
+		FnMut<void()> done);
+	void applyDifferenceChunks();
 	void stateDone(const MTPupdates_State &state);
 	void setState(int32 pts, int32 date, int32 qts, int32 seq);
 	void channelDifferenceDone(
@@ -174,6 +189,18 @@ private:
 		not_null<ChannelData*>,
 		mtpRequestId> _rangeDifferenceRequests;
 
+	// Channels waiting for a getChannelDifference request slot.
+	base::flat_map<
+		not_null<ChannelData*>,
+		QueuedChannelDifference> _channelDifferenceQueue;
+	int _channelDifferenceQueueOrder = 0;
+	int _channelDifferenceRequests = 0;
+
+	// Large difference is applied in parts between event loop iterations.
+	std::deque<FnMut<void()>> _differenceChunks;
+	base::Timer _differenceChunksTimer;
+	rpl::variable<bool> _catchingUp = false;
+
 	crl::time _lastUpdateTime = 0;
 	bool _handlingChannelDifference = false;
 
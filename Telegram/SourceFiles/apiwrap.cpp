@@ -195,7 +195,8 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 , _selfDestruct(std::make_unique<Api::SelfDestruct>(this))
 , _sensitiveContent(std::make_unique<Api::SensitiveContent>(this))
 , _globalPrivacy(std::make_unique<Api::GlobalPrivacy>(this))
-, _inviteLinks(std::make_unique<Api::InviteLinks>(this)) {
+, _inviteLinks(std::make_unique<Api::InviteLinks>(this))
+, _searchResultsCache(std::make_unique<Api::SearchResultsCache>()) {
 	crl::on_main(session, [=] {
 		// You can't use _session->lifetime() in the constructor,
 		// only queued, because it is not constructed yet.
@@ -212,6 +213,7 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 		}, _session->lifetime());
 
 		setupSupportMode();
+		setupSearchResultsCache();
 
 		Core::App().settings().proxy().connectionTypeValue(
 		) | rpl::start_with_next([=] {
@@ -246,6 +248,26 @@ void ApiWrap::setupSupportMode() {
 	}, _session->lifetime());
 }
 
+void ApiWrap::setupSearchResultsCache() {
+	const auto cache = _searchResultsCache.get();
+	_session->data().itemRemoved(
+	) | rpl::start_with_next([=](not_null<const HistoryItem*> item) {
+		cache->removeOne(item->history()->peer->id, item->id);
+	}, _session->lifetime());
+
+	_session->data().historyCleared(
+	) | rpl::start_with_next([=](not_null<const History*> history) {
+		cache->removePeer(history->peer->id);
+	}, _session->lifetime());
+
+	// We don't know if a new message matches the cached queries.
+	_session->changes().messageUpdates(
+		Data::MessageUpdate::Flag::NewAdded
+	) | rpl::start_with_next([=](const Data::MessageUpdate &update) {
+		cache->removePeer(update.item->history()->peer->id);
+	}, _session->lifetime());
+}
+
 void ApiWrap::requestChangelog(
 		const QString &sinceVersion,
 		Fn<void(const MTPUpdates &result)> callback) {
@@ -563,6 +585,17 @@ void ApiWrap::requestMessageData(ChannelData *channel, MsgId msgId, RequestMessa
 	if (!req.requestId) _messageDataResolveDelayed.call();
 }
 
+void ApiWrap::requestMessageDataResult(
+		ChannelData *channel,
+		MsgId msgId,
+		MessageDataResultCallback callback) {
+	auto &req = (channel
+		? _channelMessageDataRequests[channel][msgId]
+		: _messageDataRequests[msgId]);
+	req.resultCallbacks.append(std::move(callback));
+	if (!req.requestId) _messageDataResolveDelayed.call();
+}
+
 QVector<MTPInputMessage> ApiWrap::collectMessageIds(const MessageDataRequests &requests) {
 	auto result = QVector<MTPInputMessage>();
 	result.reserve(requests.size());
@@ -597,7 +630,7 @@ void ApiWrap::resolveMessageDatas() {
 		)).done([this](const MTPmessages_Messages &result, mtpRequestId requestId) {
 			gotMessageDatas(nullptr, result, requestId);
 		}).fail([this](const MTP::Error &error, mtpRequestId requestId) {
-			finalizeMessageDataRequest(nullptr, requestId);
+			finalizeMessageDataRequest(nullptr, requestId, false);
 		}).afterDelay(kSmallDelayMs).send();
 		for (auto &request : _messageDataRequests) {
 			if (request.requestId > 0) continue;
@@ -618,7 +651,7 @@ void ApiWrap::resolveMessageDatas() {
 			)).done([=](const MTPmessages_Messages &result, mtpRequestId requestId) {
 				gotMessageDatas(channel, result, requestId);
 			}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
-				finalizeMessageDataRequest(channel, requestId);
+				finalizeMessageDataRequest(channel, requestId, false);
 			}).afterDelay(kSmallDelayMs).send();
 
 			for (auto &request : *j) {
@@ -658,12 +691,13 @@ void ApiWrap::gotMessageDatas(ChannelData *channel, const MTPmessages_Messages &
 		LOG(("API Error: received messages.messagesNotModified! (ApiWrap::gotDependencyItem)"));
 		break;
 	}
-	finalizeMessageDataRequest(channel, requestId);
+	finalizeMessageDataRequest(channel, requestId, true);
 }
 
 void ApiWrap::finalizeMessageDataRequest(
 		ChannelData *channel,
-		mtpRequestId requestId) {
+		mtpRequestId requestId,
+		bool answered) {
 	auto requests = messageDataRequests(channel, true);
 	if (requests) {
 		for (auto i = requests->begin(); i != requests->cend();) {
@@ -671,6 +705,9 @@ void ApiWrap::finalizeMessageDataRequest(
 				for_const (auto &callback, i.value().callbacks) {
 					callback(channel, i.key());
 				}
+				for_const (auto &callback, i.value().resultCallbacks) {
+					callback(answered);
+				}
 				i = requests->erase(i);
 			} else {
 				++i;
@@ -796,6 +833,9 @@ void ApiWrap::requestDialogs(Data::Folder *folder) {
 	if (folder && !_foldersLoadState.contains(folder)) {
 		_foldersLoadState.emplace(folder, DialogsLoadState());
 	}
+	if (!folder && !_dialogsSnapshotApplied && !_session->supportMode()) {
+		applyDialogsSnapshot();
+	}
 	requestMoreDialogs(folder);
 }
 
@@ -855,6 +895,10 @@ void ApiWrap::requestMoreDialogs(Data::Folder *folder) {
 				count);
 		});
 
+		if (!folder && firstLoad && _dialogsSnapshot) {
+			const auto state = dialogsLoadState(folder);
+			dialogsSnapshotListReceived(result, state ? state->offsetDate : 0);
+		}
 		if (!folder
 			&& (!_dialogsLoadState || !_dialogsLoadState->listReceived)) {
 			refreshDialogsLoadBlocked();
@@ -1006,11 +1050,111 @@ void ApiWrap::requestPinnedDialogs(Data::Folder *folder) {
 			_session->data().chatsListChanged(folder);
 			_session->data().notifyPinnedDialogsOrderUpdated();
 		});
+		if (!folder && _dialogsSnapshot) {
+			dialogsSnapshotPinnedReceived(result);
+		}
 	}).fail([=](const MTP::Error &error) {
 		finalize();
 	}).send();
 }
 
+void ApiWrap::applyDialogsSnapshot() {
+	_dialogsSnapshotApplied = true;
+	_dialogsSnapshot = std::make_unique<DialogsSnapshotState>();
+
+	const auto snapshot = _session->local().readChatListSnapshot();
+	if (!snapshot) {
+		return;
+	}
+	const auto started = crl::now();
+	auto &owner = _session->data();
+	const auto apply = [&](const auto &data) {
+		owner.processCachedUsers(data.vusers());
+		owner.processCachedChats(data.vchats());
+		owner.applyDialogs(nullptr, data.vmessages().v, data.vdialogs().v);
+		for (const auto &dialog : data.vdialogs().v) {
+			dialog.match([&](const MTPDdialog &data) {
+				const auto peerId = peerFromMTP(data.vpeer());
+				if (const auto history = owner.historyLoaded(peerId)) {
+					_dialogsSnapshot->shown.emplace(
+						history,
+						history->chatListTimeId());
+				}
+			}, [](const MTPDdialogFolder &) {
+			});
+		}
+	};
+	snapshot->pinned.match(apply);
+	snapshot->list.match([](const MTPDmessages_dialogsNotModified &) {
+	}, apply);
+	owner.chatsListChanged(nullptr);
+	owner.notifyPinnedDialogsOrderUpdated();
+
+	LOG(("Startup: chat list snapshot with %1 chats applied in %2 ms."
+		).arg(_dialogsSnapshot->shown.size()
+		).arg(crl::now() - started));
+}
+
+void ApiWrap::dialogsSnapshotListReceived(
+		const MTPmessages_Dialogs &result,
+		TimeId till) {
+	result.match([](const MTPDmessages_dialogsNotModified &) {
+	}, [&](const auto &data) {
+		forgetDialogsSnapshotEntries(data.vdialogs().v);
+	});
+	_dialogsSnapshot->list = result;
+	_dialogsSnapshot->listTill = till;
+	finishDialogsSnapshot();
+}
+
+void ApiWrap::dialogsSnapshotPinnedReceived(
+		const MTPmessages_PeerDialogs &result) {
+	result.match([&](const MTPDmessages_peerDialogs &data) {
+		forgetDialogsSnapshotEntries(data.vdialogs().v);
+	});
+	_dialogsSnapshot->pinned = result;
+	finishDialogsSnapshot();
+}
+
+void ApiWrap::forgetDialogsSnapshotEntries(
+		const QVector<MTPDialog> &dialogs) {
+	auto &shown = _dialogsSnapshot->shown;
+	if (shown.empty()) {
+		return;
+	}
+	for (const auto &dialog : dialogs) {
+		dialog.match([&](const MTPDdialog &data) {
+			const auto peerId = peerFromMTP(data.vpeer());
+			if (const auto history = _session->data().historyLoaded(peerId)) {
+				shown.remove(history);
+			}
+		}, [](const MTPDdialogFolder &) {
+		});
+	}
+}
+
+void ApiWrap::finishDialogsSnapshot() {
+	if (!_dialogsSnapshot->list || !_dialogsSnapshot->pinned) {
+		return;
+	}
+	const auto snapshot = base::take(_dialogsSnapshot);
+
+	// Chats from the snapshot that the server didn't return this time,
+	// though it should have, and that were not updated since are stale.
+	auto &owner = _session->data();
+	for (const auto &[history, date] : snapshot->shown) {
+		if (history->chatListTimeId() == date
+			&& date > snapshot->listTill
+			&& !history->isPinnedDialog(0)) {
+			owner.removeChatListEntry(history);
+		}
+	}
+	_session->local().writeChatListSnapshot({
+		.list = *snapshot->list,
+		.pinned = *snapshot->pinned,
+	});
+}
+
 void ApiWrap::requestMoreBlockedByDateDialogs() {
 	if (!_dialogsLoadState) {
 		return;
@@ -5097,6 +5241,10 @@ Api::InviteLinks &ApiWrap::inviteLinks() {
 	return *_inviteLinks;
 }
 
+Api::SearchResultsCache &ApiWrap::searchResultsCache() {
+	return *_searchResultsCache;
+}
+
 void ApiWrap::createPoll(
 		const PollData &data,
 		const SendAction &action,
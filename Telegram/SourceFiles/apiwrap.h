@@ -62,6 +62,7 @@ class SelfDestruct;
 class SensitiveContent;
 class GlobalPrivacy;
 class InviteLinks;
+class SearchResultsCache;
 
 namespace details {
 
@@ -187,6 +188,15 @@ public:
 		ChannelData *channel,
 		MsgId msgId,
 		RequestMessageDataCallback callback);
+
+	// The callback gets false if the request failed, so the message
+	// could exist even though it wasn't received.
+	using MessageDataResultCallback = Fn<void(bool answered)>;
+	void requestMessageDataResult(
+		ChannelData *channel,
+		MsgId msgId,
+		MessageDataResultCallback callback);
+
 	QString exportDirectMessageLink(
 		not_null<HistoryItem*> item,
 		bool inRepliesContext);
@@ -457,6 +467,7 @@ public:
 	[[nodiscard]] Api::SensitiveContent &sensitiveContent();
 	[[nodiscard]] Api::GlobalPrivacy &globalPrivacy();
 	[[nodiscard]] Api::InviteLinks &inviteLinks();
+	[[nodiscard]] Api::SearchResultsCache &searchResultsCache();
 
 	void createPoll(
 		const PollData &data,
@@ -472,8 +483,10 @@ public:
 private:
 	struct MessageDataRequest {
 		using Callbacks = QList<RequestMessageDataCallback>;
+		using ResultCallbacks = QList<MessageDataResultCallback>;
 		mtpRequestId requestId = 0;
 		Callbacks callbacks;
+		ResultCallbacks resultCallbacks;
 	};
 	using MessageDataRequests = QMap<MsgId, MessageDataRequest>;
 	using SharedMediaType = Storage::SharedMediaType;
@@ -495,7 +508,15 @@ private:
 		bool pinnedReceived = false;
 	};
 
+	struct DialogsSnapshotState {
+		base::flat_map<not_null<History*>, TimeId> shown;
+		std::optional<MTPmessages_Dialogs> list;
+		std::optional<MTPmessages_PeerDialogs> pinned;
+		TimeId listTill = 0;
+	};
+
 	void setupSupportMode();
+	void setupSearchResultsCache();
 	void refreshDialogsLoadBlocked();
 	void updateDialogsOffset(
 		Data::Folder *folder,
@@ -504,6 +525,14 @@ private:
 	void requestMoreDialogs(Data::Folder *folder);
 	DialogsLoadState *dialogsLoadState(Data::Folder *folder);
 	void dialogsLoadFinish(Data::Folder *folder);
+	void applyDialogsSnapshot();
+	void dialogsSnapshotListReceived(
+		const MTPmessages_Dialogs &result,
+		TimeId till);
+	void dialogsSnapshotPinnedReceived(
+		const MTPmessages_PeerDialogs &result);
+	void forgetDialogsSnapshotEntries(const QVector<MTPDialog> &dialogs);
+	void finishDialogsSnapshot();
 
 	void checkQuitPreventFinished();
 
@@ -513,7 +542,8 @@ private:
 	void gotMessageDatas(ChannelData *channel, const MTPmessages_Messages &result, mtpRequestId requestId);
 	void finalizeMessageDataRequest(
 		ChannelData *channel,
-		mtpRequestId requestId);
+		mtpRequestId requestId,
+		bool answered);
 
 	QVector<MTPInputMessage> collectMessageIds(const MessageDataRequests &requests);
 	MessageDataRequests *messageDataRequests(ChannelData *channel, bool onlyExisting = false);
@@ -724,6 +754,9 @@ private:
 		not_null<Data::Folder*>,
 		DialogsLoadState> _foldersLoadState;
 
+	std::unique_ptr<DialogsSnapshotState> _dialogsSnapshot;
+	bool _dialogsSnapshotApplied = false;
+
 	rpl::event_stream<SendAction> _sendActions;
 
 	std::unique_ptr<TaskQueue> _fileLoader;
@@ -786,6 +819,7 @@ private:
 	const std::unique_ptr<Api::SensitiveContent> _sensitiveContent;
 	const std::unique_ptr<Api::GlobalPrivacy> _globalPrivacy;
 	const std::unique_ptr<Api::InviteLinks> _inviteLinks;
+	const std::unique_ptr<Api::SearchResultsCache> _searchResultsCache;
 
 	base::flat_map<FullMsgId, mtpRequestId> _pollVotesRequestIds;
 	base::flat_map<FullMsgId, mtpRequestId> _pollCloseRequestIds;
@@ -18,6 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/emoji_config.h"
 #include "storage/storage_account.h"
 #include "storage/cache/storage_cache_database.h"
+#include "storage/storage_cache_budget.h"
 #include "data/data_session.h"
 #include "lang/lang_keys.h"
 #include "mainwindow.h"
@@ -35,6 +36,11 @@ constexpr auto kTimeLimitsCount = 16;
 constexpr auto kMaxTimeLimitValue = std::numeric_limits<size_type>::max();
 constexpr auto kFakeMediaCacheTag = uint16(0xFFFF);
 
+[[nodiscard]] bool IsBigFileTag(uint16 tag) {
+	return (tag == Data::kStreamingCacheTag)
+		|| (tag == Data::kLottieFramesCacheTag);
+}
+
 int64 TotalSizeLimitInMB(int index) {
 	if (index < 8) {
 		return int64(index + 2) * 100;
@@ -128,7 +134,7 @@ public:
 		rpl::producer<QString> clear,
 		const Database::TaggedSummary &data);
 
-	void update(const Database::TaggedSummary &data);
+	void update(const Database::TaggedSummary &data, int64 quota);
 	void toggleProgress(bool shown);
 
 	rpl::producer<> clearRequests() const;
@@ -148,6 +154,7 @@ private:
 	object_ptr<Ui::FlatLabel> _clearing = { nullptr };
 	object_ptr<Ui::RoundButton> _clear;
 	std::unique_ptr<Ui::InfiniteRadialAnimation> _progress;
+	int64 _quota = 0;
 
 };
 
@@ -170,7 +177,10 @@ LocalStorageBox::Row::Row(
 	_clear->setVisible(data.count != 0);
 }
 
-void LocalStorageBox::Row::update(const Database::TaggedSummary &data) {
+void LocalStorageBox::Row::update(
+		const Database::TaggedSummary &data,
+		int64 quota) {
+	_quota = quota;
 	if (data.count != 0) {
 		_title->setText(titleText(data));
 	}
@@ -259,9 +269,17 @@ QString LocalStorageBox::Row::titleText(const Database::TaggedSummary &data) con
 }
 
 QString LocalStorageBox::Row::sizeText(const Database::TaggedSummary &data) const {
-	return data.totalSize
-		? Ui::FormatSizeText(data.totalSize)
-		: tr::lng_local_storage_empty(tr::now);
+	if (!data.totalSize) {
+		return tr::lng_local_storage_empty(tr::now);
+	} else if (!_quota) {
+		return Ui::FormatSizeText(data.totalSize);
+	}
+	return tr::lng_local_storage_size_quota(
+		tr::now,
+		lt_size,
+		Ui::FormatSizeText(data.totalSize),
+		lt_limit,
+		Ui::FormatSizeText(_quota));
 }
 
 LocalStorageBox::LocalStorageBox(
@@ -305,11 +323,12 @@ void LocalStorageBox::prepare() {
 
 void LocalStorageBox::updateRow(
 		not_null<Ui::SlideWrap<Row>*> row,
-		const Database::TaggedSummary *data) {
+		const Database::TaggedSummary *data,
+		int64 quota) {
 	const auto summary = (_rows.find(0)->second == row);
 	const auto shown = (data && data->count && data->totalSize) || summary;
 	if (shown) {
-		row->entity()->update(*data);
+		row->entity()->update(*data, quota);
 	}
 	row->toggle(shown, anim::type::normal);
 }
@@ -323,14 +342,25 @@ void LocalStorageBox::update(
 		i->second->entity()->toggleProgress(
 			_stats.clearing || _statsBig.clearing);
 	}
+	const auto budget = _session->data().cacheBudget().stats();
+	const auto budgetBig = _session->data().cacheBigFileBudget().stats();
 	for (const auto &entry : _rows) {
 		if (entry.first == kFakeMediaCacheTag) {
 			updateRow(entry.second, &_statsBig.full);
+		} else if (IsBigFileTag(entry.first)) {
+			const auto i = _statsBig.tagged.find(entry.first);
+			const auto j = budgetBig.find(entry.first);
+			updateRow(
+				entry.second,
+				(i != end(_statsBig.tagged)) ? &i->second : nullptr,
+				(j != end(budgetBig)) ? j->second.quota : 0);
 		} else if (entry.first) {
 			const auto i = _stats.tagged.find(entry.first);
+			const auto j = budget.find(entry.first);
 			updateRow(
 				entry.second,
-				(i != end(_stats.tagged)) ? &i->second : nullptr);
+				(i != end(_stats.tagged)) ? &i->second : nullptr,
+				(j != end(budget)) ? j->second.quota : 0);
 		} else {
 			const auto full = summary();
 			updateRow(entry.second, &full);
@@ -348,6 +378,8 @@ auto LocalStorageBox::summary() const -> Database::TaggedSummary {
 void LocalStorageBox::clearByTag(uint16 tag) {
 	if (tag == kFakeMediaCacheTag) {
 		_dbBig->clear();
+	} else if (IsBigFileTag(tag)) {
+		_dbBig->clearByTag(tag);
 	} else if (tag) {
 		_db->clearByTag(tag);
 	} else {
@@ -385,8 +417,11 @@ void LocalStorageBox::setupControls() {
 	auto tracker = Ui::MultiSlideTracker();
 	const auto createTagRow = [&](uint8 tag, auto &&titleFactory) {
 		static const auto empty = Database::TaggedSummary();
-		const auto i = _stats.tagged.find(tag);
-		const auto &data = (i != end(_stats.tagged)) ? i->second : empty;
+		const auto &tagged = IsBigFileTag(tag)
+			? _statsBig.tagged
+			: _stats.tagged;
+		const auto i = tagged.find(tag);
+		const auto &data = (i != end(tagged)) ? i->second : empty;
 		auto factory = std::forward<decltype(titleFactory)>(titleFactory);
 		auto title = [factory = std::move(factory)](size_type count) {
 			return factory(tr::now, lt_count, count);
@@ -423,6 +458,8 @@ void LocalStorageBox::setupControls() {
 		std::move(mediaCacheTitle),
 		tr::lng_local_storage_clear_some(),
 		_statsBig.full));
+	createTagRow(Data::kStreamingCacheTag, tr::lng_local_storage_streaming);
+	createTagRow(Data::kLottieFramesCacheTag, tr::lng_local_storage_lottie);
 	shadow->toggleOn(
 		std::move(tracker).atLeastOneShownValue()
 	);
@@ -592,6 +629,9 @@ void LocalStorageBox::save() {
 	updateBig.totalTimeLimit = _timeLimit;
 	_session->local().updateCacheSettings(update, updateBig);
 	_session->data().cache().updateSettings(update);
+	_session->data().cacheBudget().setTotalSizeLimit(update.totalSizeLimit);
+	_session->data().cacheBigFileBudget().setTotalSizeLimit(
+		updateBig.totalSizeLimit);
 	closeBox();
 }
 
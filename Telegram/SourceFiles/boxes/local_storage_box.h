@@ -54,7 +54,8 @@ private:
 	void update(Database::Stats &&stats, Database::Stats &&statsBig);
 	void updateRow(
 		not_null<Ui::SlideWrap<Row>*> row,
-		const Database::TaggedSummary *data);
+		const Database::TaggedSummary *data,
+		int64 quota = 0);
 	void setupControls();
 	void setupLimits(not_null<Ui::VerticalLayout*> container);
 	void updateMediaLimit();
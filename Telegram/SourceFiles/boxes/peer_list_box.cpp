@@ -867,17 +867,17 @@ void PeerListContent::addToSearchIndex(not_null<PeerListRow*> row) {
 	}
 
 	removeFromSearchIndex(row);
-	row->setNameFirstLetters(row->peer()->nameFirstLetters());
-	for (auto ch : row->nameFirstLetters()) {
-		_searchIndex[ch].push_back(row);
+	row->setNameWords(row->peer()->nameWords());
+	for (const auto &word : row->nameWords()) {
+		_searchIndex[word].push_back(row);
 	}
 }
 
 void PeerListContent::removeFromSearchIndex(not_null<PeerListRow*> row) {
-	const auto &nameFirstLetters = row->nameFirstLetters();
-	if (!nameFirstLetters.empty()) {
-		for (auto ch : row->nameFirstLetters()) {
-			auto it = _searchIndex.find(ch);
+	const auto &nameWords = row->nameWords();
+	if (!nameWords.empty()) {
+		for (const auto &word : nameWords) {
+			auto it = _searchIndex.find(word);
 			if (it != _searchIndex.cend()) {
 				auto &entry = it->second;
 				entry.erase(ranges::remove(entry, row), end(entry));
@@ -886,10 +886,20 @@ void PeerListContent::removeFromSearchIndex(not_null<PeerListRow*> row) {
 				}
 			}
 		}
-		row->setNameFirstLetters({});
+		row->setNameWords({});
 	}
 }
 
+auto PeerListContent::searchIndexRange(const QString &word) const
+-> std::pair<SearchIndexIterator, SearchIndexIterator> {
+	const auto from = _searchIndex.lower_bound(word);
+	auto till = from;
+	while (till != _searchIndex.end() && till->first.startsWith(word)) {
+		++till;
+	}
+	return { from, till };
+}
+
 void PeerListContent::prependRow(std::unique_ptr<PeerListRow> row) {
 	Expects(row != nullptr);
 
@@ -1659,45 +1669,52 @@ void PeerListContent::searchQueryChanged(QString query) {
 		if (_controller->searchInLocal() && !searchWordsList.isEmpty()) {
 			Assert(_hiddenRows.empty());
 
-			auto minimalList = (const std::vector<not_null<PeerListRow*>>*)nullptr;
+			// Take the rows from the query word with the fewest candidates.
+			auto minimalRange = std::optional<
+				std::pair<SearchIndexIterator, SearchIndexIterator>>();
+			auto minimalCount = std::size_t();
 			for (const auto &searchWord : searchWordsList) {
-				auto searchWordStart = searchWord[0].toLower();
-				auto it = _searchIndex.find(searchWordStart);
-				if (it == _searchIndex.cend()) {
+				const auto range = searchIndexRange(searchWord);
+				auto count = std::size_t();
+				for (auto i = range.first; i != range.second; ++i) {
+					count += i->second.size();
+				}
+				if (!count) {
 					// Some word can't be found in any row.
-					minimalList = nullptr;
+					minimalRange = std::nullopt;
 					break;
-				} else if (!minimalList || minimalList->size() > it->second.size()) {
-					minimalList = &it->second;
+				} else if (!minimalRange || minimalCount > count) {
+					minimalRange = range;
+					minimalCount = count;
 				}
 			}
-			if (minimalList) {
-				auto searchWordInNames = [](
-						not_null<PeerData*> peer,
-						const QString &searchWord) {
-					for (auto &nameWord : peer->nameWords()) {
-						if (nameWord.startsWith(searchWord)) {
-							return true;
-						}
-					}
-					return false;
-				};
+			if (minimalRange) {
 				auto allSearchWordsInNames = [&](
 						not_null<PeerData*> peer) {
-					for (const auto &searchWord : searchWordsList) {
-						if (!searchWordInNames(peer, searchWord)) {
-							return false;
-						}
-					}
-					return true;
+					return Data::NameWordsMatch(
+						peer->nameWords(),
+						searchWordsList);
 				};
 
-				_filterResults.reserve(minimalList->size());
-				for (const auto row : *minimalList) {
-					if (!row->special() && allSearchWordsInNames(row->peer())) {
-						_filterResults.push_back(row);
+				_filterResults.reserve(minimalCount);
+				const auto &[from, till] = *minimalRange;
+				for (auto i = from; i != till; ++i) {
+					for (const auto row : i->second) {
+						if (!row->special()
+							&& allSearchWordsInNames(row->peer())) {
+							_filterResults.push_back(row);
+						}
 					}
 				}
+
+				// Several name words of one row may start with the query.
+				const auto byIndex = [](not_null<PeerListRow*> row) {
+					return row->absoluteIndex();
+				};
+				ranges::sort(_filterResults, std::less<>(), byIndex);
+				_filterResults.erase(
+					ranges::unique(_filterResults),
+					end(_filterResults));
 			}
 		}
 		if (_controller->hasComplexSearch()) {
@@ -194,11 +194,11 @@ public:
 		int outerWidth);
 	float64 checkedRatio();
 
-	void setNameFirstLetters(const base::flat_set<QChar> &firstLetters) {
-		_nameFirstLetters = firstLetters;
+	void setNameWords(const base::flat_set<QString> &words) {
+		_nameWords = words;
 	}
-	const base::flat_set<QChar> &nameFirstLetters() const {
-		return _nameFirstLetters;
+	const base::flat_set<QString> &nameWords() const {
+		return _nameWords;
 	}
 
 	virtual void lazyInitialize(const style::PeerListItem &st);
@@ -240,7 +240,7 @@ private:
 	Ui::Text::String _status;
 	StatusType _statusType = StatusType::Online;
 	crl::time _statusValidTill = 0;
-	base::flat_set<QChar> _nameFirstLetters;
+	base::flat_set<QString> _nameWords;
 	int _absoluteIndex = -1;
 	State _disabledState = State::Active;
 	bool _hidden : 1;
@@ -591,9 +591,6 @@ public:
 	template <typename ReorderCallback>
 	void reorderRows(ReorderCallback &&callback) {
 		callback(_rows.begin(), _rows.end());
-		for (auto &searchEntity : _searchIndex) {
-			callback(searchEntity.second.begin(), searchEntity.second.end());
-		}
 		refreshIndices();
 		if (!_hiddenRows.empty()) {
 			callback(_filterResults.begin(), _filterResults.end());
@@ -705,6 +702,12 @@ private:
 	void addToSearchIndex(not_null<PeerListRow*> row);
 	bool addingToSearchIndex() const;
 	void removeFromSearchIndex(not_null<PeerListRow*> row);
+	using SearchIndex = std::map<
+		QString,
+		std::vector<not_null<PeerListRow*>>>;
+	using SearchIndexIterator = SearchIndex::const_iterator;
+	[[nodiscard]] auto searchIndexRange(const QString &word) const
+		-> std::pair<SearchIndexIterator, SearchIndexIterator>;
 	void setSearchQuery(const QString &query, const QString &normalizedQuery);
 	bool showingSearch() const {
 		return !_hiddenRows.empty() || !_searchQuery.isEmpty();
@@ -748,7 +751,9 @@ private:
 	std::map<PeerListRowId, not_null<PeerListRow*>> _rowsById;
 	std::map<PeerData*, std::vector<not_null<PeerListRow*>>> _rowsByPeer;
 
-	std::map<QChar, std::vector<not_null<PeerListRow*>>> _searchIndex;
+	// Name word -> rows, so that all the words starting with
+	// a query word form one contiguous range of the map.
+	SearchIndex _searchIndex;
 	QString _searchQuery;
 	QString _normalizedSearchQuery;
 	QString _mentionHighlight;
@@ -1139,21 +1139,7 @@ void AddSpecialBoxSearchController::addChatMembers(
 	}
 	const auto allWordsAreFound = [&](
 			const base::flat_set<QString> &nameWords) {
-		const auto hasNamePartStartingWith = [&](const QString &word) {
-			for (const auto &nameWord : nameWords) {
-				if (nameWord.startsWith(word)) {
-					return true;
-				}
-			}
-			return false;
-		};
-
-		for (const auto &word : wordList) {
-			if (!hasNamePartStartingWith(word)) {
-				return false;
-			}
-		}
-		return true;
+		return Data::NameWordsMatch(nameWords, wordList);
 	};
 
 	for (const auto user : chat->participants) {
@@ -1172,21 +1158,7 @@ void AddSpecialBoxSearchController::addChatsContacts() {
 	}
 	const auto allWordsAreFound = [&](
 			const base::flat_set<QString> &nameWords) {
-		const auto hasNamePartStartingWith = [&](const QString &word) {
-			for (const auto &nameWord : nameWords) {
-				if (nameWord.startsWith(word)) {
-					return true;
-				}
-			}
-			return false;
-		};
-
-		for (const auto &word : wordList) {
-			if (!hasNamePartStartingWith(word)) {
-				return false;
-			}
-		}
-		return true;
+		return Data::NameWordsMatch(nameWords, wordList);
 	};
 	const auto getSmallestIndex = [&](not_null<Dialogs::IndexedList*> list)
 	-> const Dialogs::List* {
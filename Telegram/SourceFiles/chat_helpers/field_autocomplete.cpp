@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_peer_values.h"
 #include "data/data_file_origin.h"
 #include "data/data_session.h"
+#include "data/data_changes.h"
 #include "data/stickers/data_stickers.h"
 #include "chat_helpers/send_context_menu.h" // SendMenu::FillSendMenu
 #include "chat_helpers/stickers_lottie.h"
@@ -44,6 +45,13 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtWidgets/QApplication>
 
+namespace {
+
+constexpr auto kMentionsSearchDelay = crl::time(300);
+constexpr auto kMentionsSearchLimit = 50;
+
+} // namespace
+
 class FieldAutocomplete::Inner final : public Ui::RpWidget {
 public:
 	struct ScrollTo {
@@ -143,7 +151,9 @@ FieldAutocomplete::FieldAutocomplete(
 	not_null<Window::SessionController*> controller)
 : RpWidget(parent)
 , _controller(controller)
-, _scroll(this) {
+, _scroll(this)
+, _api(&controller->session().mtp())
+, _mentionsSearchTimer([=] { requestMentionsSearch(); }) {
 	hide();
 
 	_scroll->setGeometry(rect());
@@ -225,6 +235,7 @@ void FieldAutocomplete::showFiltered(
 	_chat = peer->asChat();
 	_user = peer->asUser();
 	_channel = peer->asChannel();
+	setMentionsPeer(peer);
 	if (query.isEmpty()) {
 		_type = Type::Mentions;
 		rowsUpdated(
@@ -282,6 +293,7 @@ void FieldAutocomplete::showStickers(EmojiPtr emoji) {
 	_chat = nullptr;
 	_user = nullptr;
 	_channel = nullptr;
+	setMentionsPeer(nullptr);
 
 	updateFiltered(resetScroll);
 }
@@ -334,6 +346,170 @@ FieldAutocomplete::StickerRows FieldAutocomplete::getStickerSuggestions() {
 	return result;
 }
 
+void FieldAutocomplete::setMentionsPeer(PeerData *peer) {
+	if (_mentionsPeer == peer) {
+		return;
+	}
+	_mentionsPeer = peer;
+	_mentionsIndex.clear();
+	_mentionsIndexStale = true;
+	_mentionsPeerLifetime.destroy();
+	_mentionsSearchCache.clear();
+	_mentionsSearchTimer.cancel();
+	_api.request(base::take(_mentionsSearchRequestId)).cancel();
+	if (!peer || peer->isUser()) {
+		return;
+	}
+	const auto changes = &peer->session().changes();
+	changes->peerUpdates(
+		peer,
+		Data::PeerUpdate::Flag::Members
+	) | rpl::start_with_next([=] {
+		_mentionsIndexStale = true;
+	}, _mentionsPeerLifetime);
+
+	using Flag = Data::PeerUpdate::Flag;
+	changes->peerUpdates(
+		Flag::Name | Flag::Username
+	) | rpl::filter([](const Data::PeerUpdate &update) {
+		return update.peer->isUser();
+	}) | rpl::start_with_next([=] {
+		_mentionsIndexStale = true;
+	}, _mentionsPeerLifetime);
+}
+
+void FieldAutocomplete::refreshMentionsIndex() {
+	if (!_mentionsIndexStale) {
+		return;
+	}
+	_mentionsIndexStale = false;
+	_mentionsIndex.clear();
+
+	const auto add = [&](not_null<UserData*> user) {
+		if (!user->username.isEmpty()) {
+			_mentionsIndex.emplace_back(user->username.toLower(), user);
+		}
+		for (const auto &word : user->nameWords()) {
+			_mentionsIndex.emplace_back(word, user);
+		}
+	};
+	if (_chat) {
+		// Last authors change with every new message without any
+		// notification, so they're matched directly in findMentions().
+		for (const auto user : _chat->participants) {
+			add(user);
+		}
+	} else if (_channel && _channel->isMegagroup()) {
+		for (const auto user : _channel->mgInfo->lastParticipants) {
+			add(user);
+		}
+	}
+	ranges::sort(_mentionsIndex);
+	_mentionsIndex.erase(
+		ranges::unique(_mentionsIndex),
+		end(_mentionsIndex));
+}
+
+base::flat_set<not_null<UserData*>> FieldAutocomplete::findMentions() {
+	refreshMentionsIndex();
+
+	using Key = std::pair<QString, not_null<UserData*>>;
+	auto result = base::flat_set<not_null<UserData*>>();
+	auto i = ranges::lower_bound(
+		_mentionsIndex,
+		_filter,
+		std::less<>(),
+		&Key::first);
+	// Don't suggest the username that is already typed in full.
+	const auto typedInFull = [&](not_null<UserData*> user) {
+		return !user->username.compare(_filter, Qt::CaseInsensitive);
+	};
+	for (; i != end(_mentionsIndex) && i->first.startsWith(_filter); ++i) {
+		const auto user = i->second;
+		if (!typedInFull(user)) {
+			result.emplace(user);
+		}
+	}
+	if (_chat) {
+		for (const auto user : _chat->lastAuthors) {
+			const auto matches = user->username.startsWith(
+					_filter,
+					Qt::CaseInsensitive)
+				|| Data::NameWordsHavePrefix(user->nameWords(), _filter);
+			if (matches && !typedInFull(user)) {
+				result.emplace(user);
+			}
+		}
+	}
+	return result;
+}
+
+bool FieldAutocomplete::mentionsNeedServerSearch() const {
+	if (!_channel
+		|| !_channel->isMegagroup()
+		|| _channel->lastParticipantsRequestNeeded()) {
+		return false;
+	}
+	const auto known = int(_channel->mgInfo->lastParticipants.size());
+	return (_channel->membersCount() > known);
+}
+
+void FieldAutocomplete::requestMentionsSearch() {
+	if (_type != Type::Mentions
+		|| _filter.isEmpty()
+		|| !mentionsNeedServerSearch()
+		|| _mentionsSearchCache.contains(_filter)) {
+		return;
+	}
+	const auto channel = _channel;
+	const auto query = _filter;
+	const auto participantsHash = 0;
+	_api.request(base::take(_mentionsSearchRequestId)).cancel();
+	_mentionsSearchRequestId = _api.request(MTPchannels_GetParticipants(
+		channel->inputChannel,
+		MTP_channelParticipantsSearch(MTP_string(query)),
+		MTP_int(0),
+		MTP_int(kMentionsSearchLimit),
+		MTP_int(participantsHash)
+	)).done([=](const MTPchannels_ChannelParticipants &result) {
+		_mentionsSearchRequestId = 0;
+		mentionsSearchDone(channel, query, result);
+	}).fail([=](const MTP::Error &error) {
+		_mentionsSearchRequestId = 0;
+		_mentionsSearchCache[query];
+	}).send();
+}
+
+void FieldAutocomplete::mentionsSearchDone(
+		not_null<ChannelData*> channel,
+		const QString &query,
+		const MTPchannels_ChannelParticipants &result) {
+	if (_channel != channel) {
+		return;
+	}
+	auto &found = _mentionsSearchCache[query];
+	channel->session().api().parseChannelParticipants(channel, result, [&](
+			int availableCount,
+			const QVector<MTPChannelParticipant> &list) {
+		for (const auto &participant : list) {
+			const auto user = participant.match([](
+					const MTPDchannelParticipantBanned &data) {
+				return (UserData*)nullptr;
+			}, [](const MTPDchannelParticipantLeft &data) {
+				return (UserData*)nullptr;
+			}, [&](const auto &data) {
+				return channel->owner().userLoaded(data.vuser_id());
+			});
+			if (user) {
+				found.push_back(user);
+			}
+		}
+	});
+	if (_type == Type::Mentions && _filter == query) {
+		updateFiltered();
+	}
+}
+
 void FieldAutocomplete::updateFiltered(bool resetScroll) {
 	int32 now = base::unixtime::now(), recentInlineBots = 0;
 	MentionRows mrows;
@@ -362,17 +538,14 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 			}
 			return true;
 		};
-		auto filterNotPassedByName = [&](UserData *user) -> bool {
-			for (const auto &nameWord : user->nameWords()) {
-				if (nameWord.startsWith(_filter, Qt::CaseInsensitive)) {
-					auto exactUsername = (user->username.compare(_filter, Qt::CaseInsensitive) == 0);
-					return exactUsername;
-				}
-			}
-			return filterNotPassedByUsername(user);
+		bool listAllSuggestions = _filter.isEmpty();
+		const auto found = listAllSuggestions
+			? base::flat_set<not_null<UserData*>>()
+			: findMentions();
+		auto filterNotPassedByName = [&](not_null<UserData*> user) {
+			return !found.contains(user);
 		};
 
-		bool listAllSuggestions = _filter.isEmpty();
 		if (_addInlineBots) {
 			for_const (auto user, cRecentInlineBots()) {
 				if (user->isInaccessible()) continue;
@@ -420,6 +593,18 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 					mrows.push_back({ user });
 				}
 			}
+			if (!listAllSuggestions && mentionsNeedServerSearch()) {
+				const auto i = _mentionsSearchCache.find(_filter);
+				if (i == end(_mentionsSearchCache)) {
+					_mentionsSearchTimer.callOnce(kMentionsSearchDelay);
+				} else {
+					for (const auto user : i->second) {
+						if (user->isInaccessible()) continue;
+						if (ranges::contains(mrows, user, &MentionRow::user)) continue;
+						mrows.push_back({ user });
+					}
+				}
+			}
 		}
 	} else if (_type == Type::Hashtags) {
 		bool listAllSuggestions = _filter.isEmpty();
@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/rp_widget.h"
 #include "base/timer.h"
 #include "base/object_ptr.h"
+#include "mtproto/sender.h"
 
 namespace Ui {
 class PopupMenu;
@@ -154,6 +155,16 @@ private:
 	void recount(bool resetScroll = false);
 	StickerRows getStickerSuggestions();
 
+	void setMentionsPeer(PeerData *peer);
+	void refreshMentionsIndex();
+	[[nodiscard]] base::flat_set<not_null<UserData*>> findMentions();
+	[[nodiscard]] bool mentionsNeedServerSearch() const;
+	void requestMentionsSearch();
+	void mentionsSearchDone(
+		not_null<ChannelData*> channel,
+		const QString &query,
+		const MTPchannels_ChannelParticipants &result);
+
 	const not_null<Window::SessionController*> _controller;
 	QPixmap _cache;
 	MentionRows _mrows;
@@ -191,6 +202,21 @@ private:
 
 	Ui::Animations::Simple _a_opacity;
 
+	// Sorted usernames and name words of the known members,
+	// rebuilt lazily after the members list of the chat changes.
+	PeerData *_mentionsPeer = nullptr;
+	std::vector<std::pair<QString, not_null<UserData*>>> _mentionsIndex;
+	bool _mentionsIndexStale = true;
+	rpl::lifetime _mentionsPeerLifetime;
+
+	// Server search for members not loaded locally in large megagroups.
+	MTP::Sender _api;
+	base::Timer _mentionsSearchTimer;
+	mtpRequestId _mentionsSearchRequestId = 0;
+	base::flat_map<
+		QString,
+		std::vector<not_null<UserData*>>> _mentionsSearchCache;
+
 	Fn<bool(int)> _moderateKeyActivateCallback;
 
 };
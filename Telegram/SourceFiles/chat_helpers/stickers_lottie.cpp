@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "data/data_file_origin.h"
 #include "storage/cache/storage_cache_database.h"
+#include "storage/storage_cache_budget.h"
 #include "ui/effects/path_shift_gradient.h"
 #include "main/main_session.h"
 
@@ -37,15 +38,26 @@ auto LottieCachedFromContent(
 		baseKey.high,
 		baseKey.low + keyShift
 	};
+	const auto weak = base::make_weak(session.get());
 	const auto get = [=](FnMut<void(QByteArray &&cached)> handler) {
-		session->data().cacheBigFile().get(
-			key,
-			std::move(handler));
+		auto done = [=, handler = std::move(handler)](
+				QByteArray &&cached) mutable {
+			if (!cached.isEmpty()) {
+				crl::on_main(weak, [=] {
+					weak->data().cacheBigFileBudget().used(key);
+				});
+			}
+			handler(std::move(cached));
+		};
+		session->data().cacheBigFile().get(key, std::move(done));
 	};
-	const auto weak = base::make_weak(session.get());
 	const auto put = [=](QByteArray &&cached) {
 		crl::on_main(weak, [=, data = std::move(cached)]() mutable {
-			weak->data().cacheBigFile().put(key, std::move(data));
+			weak->data().cacheBigFileBudget().put(
+				key,
+				Storage::Cache::Database::TaggedValue(
+					std::move(data),
+					Data::kLottieFramesCacheTag));
 		});
 	};
 	return method(
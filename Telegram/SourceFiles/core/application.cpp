@@ -22,6 +22,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/local_url_handlers.h"
 #include "core/launcher.h"
 #include "core/ui_integration.h"
+#include "core/core_startup_trace.h"
 #include "chat_helpers/emoji_keywords.h"
 #include "chat_helpers/stickers_emoji_image_loader.h"
 #include "base/platform/base_platform_last_input.h"
@@ -184,6 +185,8 @@ Application::~Application() {
 }
 
 void Application::run() {
+	const auto trace = StartupTraceScope("Core::Application::run");
+
 	style::internal::StartFonts();
 
 	ThirdParty::start();
@@ -0,0 +1,137 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/core_startup_trace.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+
+#include <chrono>
+
+namespace Core {
+namespace {
+
+constexpr auto kMaxEvents = 1024;
+
+struct Event {
+	const char *name = nullptr;
+	int64 started = 0;
+	int64 duration = -1; // Instant event.
+	quintptr thread = 0;
+};
+
+struct TraceState {
+	QMutex mutex;
+	std::vector<Event> events;
+	QString path;
+	bool finished = false;
+};
+
+[[nodiscard]] TraceState &State() {
+	static TraceState result;
+	return result;
+}
+
+// Microseconds since the first traced moment.
+[[nodiscard]] int64 Now() {
+	using namespace std::chrono;
+	static const auto start = steady_clock::now();
+	return duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+void Add(Event &&event) {
+	auto &state = State();
+	QMutexLocker lock(&state.mutex);
+	if (!state.finished && state.events.size() < kMaxEvents) {
+		state.events.push_back(std::move(event));
+	}
+}
+
+[[nodiscard]] QByteArray Serialize(const std::vector<Event> &events) {
+	auto threads = base::flat_map<quintptr, int>();
+	auto result = QByteArray("{\"traceEvents\":[");
+	for (const auto &event : events) {
+		const auto i = threads.emplace(
+			event.thread,
+			int(threads.size()) + 1).first;
+		if (&event != &events.front()) {
+			result.append(',');
+		}
+		result.append("{\"name\":\"").append(event.name);
+		result.append("\",\"cat\":\"startup\",");
+		if (event.duration < 0) {
+			result.append("\"ph\":\"i\",\"s\":\"g\",");
+		} else {
+			result.append("\"ph\":\"X\",\"dur\":");
+			result.append(QByteArray::number(event.duration)).append(',');
+		}
+		result.append("\"ts\":").append(QByteArray::number(event.started));
+		result.append(",\"pid\":1,\"tid\":");
+		result.append(QByteArray::number(i->second)).append('}');
+	}
+	result.append("]}");
+	return result;
+}
+
+} // namespace
+
+StartupTraceScope::StartupTraceScope(const char *name)
+: _name(name)
+, _started(Now()) {
+}
+
+StartupTraceScope::~StartupTraceScope() {
+	Add({
+		.name = _name,
+		.started = _started,
+		.duration = Now() - _started,
+		.thread = quintptr(QThread::currentThreadId()),
+	});
+}
+
+void SetStartupTracePath(const QString &path) {
+	auto &state = State();
+	QMutexLocker lock(&state.mutex);
+	state.path = path;
+}
+
+void StartupTraceInstant(const char *name) {
+	Add({
+		.name = name,
+		.started = Now(),
+		.thread = quintptr(QThread::currentThreadId()),
+	});
+}
+
+void FinishStartupTrace() {
+	auto &state = State();
+	QMutexLocker lock(&state.mutex);
+	if (state.finished) {
+		return;
+	}
+	state.finished = true;
+	auto events = base::take(state.events);
+	const auto path = state.path;
+	lock.unlock();
+
+	if (path.isEmpty()) {
+		return;
+	}
+	ranges::sort(events, ranges::less(), &Event::started);
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly)) {
+		LOG(("Startup Error: Could not open '%1' for writing the trace."
+			).arg(path));
+		return;
+	}
+	file.write(Serialize(events));
+	LOG(("Startup Info: %1 trace events written to '%2'."
+		).arg(events.size()
+		).arg(path));
+}
+
+} // namespace Core
@@ -0,0 +1,34 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core {
+
+// Durations of the startup phases in the Chrome trace event format.
+// They are saved only if the app was launched with "-tracestartup path".
+class StartupTraceScope final {
+public:
+	explicit StartupTraceScope(const char *name);
+	~StartupTraceScope();
+
+	StartupTraceScope(const StartupTraceScope &other) = delete;
+	StartupTraceScope &operator=(const StartupTraceScope &other) = delete;
+
+private:
+	const char *_name = nullptr;
+	int64 _started = 0;
+
+};
+
+void SetStartupTracePath(const QString &path);
+void StartupTraceInstant(const char *name);
+
+// Saves the trace, all the following events are ignored.
+void FinishStartupTrace();
+
+} // namespace Core
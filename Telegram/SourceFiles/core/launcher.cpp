@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/crash_reports.h"
 #include "core/update_checker.h"
 #include "core/sandbox.h"
+#include "core/core_startup_trace.h"
 #include "base/concurrent_timer.h"
 
 #include <QtCore/QLoggingCategory>
@@ -280,6 +281,8 @@ Launcher::Launcher(
 }
 
 void Launcher::init() {
+	const auto trace = StartupTraceScope("Core::Launcher::init");
+
 	_arguments = readArguments(_argc, _argv);
 
 	prepareSettings();
@@ -335,6 +338,7 @@ int Launcher::exec() {
 	Platform::start();
 
 	auto result = executeApplication();
+	FinishStartupTrace();
 
 	DEBUG_LOG(("Telegram finished, result: %1").arg(result));
 
@@ -466,6 +470,7 @@ void Launcher::processArguments() {
 		{ "-workdir"        , KeyFormat::OneValue },
 		{ "--"              , KeyFormat::OneValue },
 		{ "-scale"          , KeyFormat::OneValue },
+		{ "-tracestartup"   , KeyFormat::OneValue },
 	};
 	auto parseResult = QMap<QByteArray, QStringList>();
 	auto parsingKey = QByteArray();
@@ -515,6 +520,8 @@ void Launcher::processArguments() {
 		}
 	}
 	gStartUrl = parseResult.value("--", {}).join(QString());
+	SetStartupTracePath(
+		parseResult.value("-tracestartup", {}).join(QString()));
 
 	const auto scaleKey = parseResult.value("-scale", {});
 	if (scaleKey.size() > 0) {
@@ -19,6 +19,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/launcher.h"
 #include "core/local_url_handlers.h"
 #include "core/update_checker.h"
+#include "core/core_startup_trace.h"
 #include "base/timer.h"
 #include "base/concurrent_timer.h"
 #include "base/invoke_queued.h"
@@ -164,6 +165,9 @@ void Sandbox::launchApplication() {
 		} else if (_application) {
 			return;
 		}
+		const auto trace = StartupTraceScope(
+			"Core::Sandbox::launchApplication");
+
 		setupScreenScale();
 
 		base::InitObservables([] {
@@ -15,6 +15,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_keys.h"
 #include "inline_bots/inline_bot_layout_item.h"
 #include "main/main_session.h"
+#include "main/main_account.h"
+#include "main/main_domain.h"
 #include "mainwidget.h"
 #include "core/file_utilities.h"
 #include "core/mime_type.h"
@@ -76,6 +78,24 @@ QString JoinStringList(const QStringList &list, const QString &separator) {
 	return result;
 }
 
+// Document ids are the same in all the accounts, so a file saved
+// by any of them can be used instead of downloading it once again.
+[[nodiscard]] Core::FileLocation FindInOtherAccounts(
+		not_null<Main::Session*> session,
+		const MediaKey &key) {
+	for (const auto &[index, account] : Core::App().domain().accounts()) {
+		if (account.get() == &session->account()
+			|| !account->sessionExists()) {
+			continue;
+		}
+		const auto location = account->local().readFileLocation(key);
+		if (!location.isEmpty() && !location.inMediaCache()) {
+			return location;
+		}
+	}
+	return Core::FileLocation();
+}
+
 } // namespace
 
 QString FileNameUnsafe(
@@ -989,7 +1009,13 @@ QByteArray documentWaveformEncode5bit(const VoiceWaveform &waveform) {
 
 const Core::FileLocation &DocumentData::location(bool check) const {
 	if (check && !_location.check()) {
-		const auto location = session().local().readFileLocation(mediaKey());
+		auto location = session().local().readFileLocation(mediaKey());
+		if (location.isEmpty()) {
+			location = FindInOtherAccounts(&session(), mediaKey());
+			if (!location.isEmpty()) {
+				session().local().writeFileLocation(mediaKey(), location);
+			}
+		}
 		const auto that = const_cast<DocumentData*>(this);
 		if (location.inMediaCache()) {
 			that->setLoadedInMediaCacheLocation();
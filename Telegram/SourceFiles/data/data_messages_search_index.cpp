@@ -0,0 +1,151 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_messages_search_index.h"
+
+#include "history/history.h"
+#include "history/history_item.h"
+#include "ui/text/text_utilities.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kMaxMemoryUsage = int64(32 * 1024 * 1024);
+
+// Rough size of a std::map node together with the word it holds.
+[[nodiscard]] int64 WordSize(const QString &word) {
+	return 64 + int64(word.size()) * int64(sizeof(QChar));
+}
+
+// Rough size of a std::set node and of the word in the item words list.
+constexpr auto kEntrySize = int64(40 + sizeof(QString));
+
+} // namespace
+
+void MessagesSearchIndex::update(
+		not_null<HistoryItem*> item,
+		const QString &text) {
+	remove(item);
+	if (item->isScheduled() || text.isEmpty()) {
+		return;
+	} else if (_memoryUsage >= kMaxMemoryUsage) {
+		if (!_limitReported) {
+			_limitReported = true;
+			LOG(("Search Index: Memory limit reached, %1 messages indexed."
+				).arg(_itemWords.size()));
+		}
+		return;
+	}
+	auto words = TextUtilities::PrepareSearchWords(text);
+	words.removeDuplicates();
+	if (words.isEmpty()) {
+		return;
+	}
+	for (auto &word : words) {
+		auto i = _words.find(word);
+		if (i == end(_words)) {
+			i = _words.emplace(word, Items()).first;
+			_memoryUsage += WordSize(word);
+		}
+		i->second.emplace(item);
+
+		// Share the string data with the map key.
+		word = i->first;
+		_memoryUsage += kEntrySize;
+	}
+	_itemWords.emplace(item, std::move(words));
+}
+
+void MessagesSearchIndex::remove(not_null<HistoryItem*> item) {
+	const auto j = _itemWords.find(item);
+	if (j == end(_itemWords)) {
+		return;
+	}
+	const auto words = std::move(j->second);
+	_itemWords.erase(j);
+	for (const auto &word : words) {
+		const auto i = _words.find(word);
+		if (i == end(_words)) {
+			continue;
+		}
+		i->second.erase(item);
+		_memoryUsage -= kEntrySize;
+		if (i->second.empty()) {
+			_memoryUsage -= WordSize(word);
+			_words.erase(i);
+		}
+	}
+}
+
+auto MessagesSearchIndex::collect(const QString &prefix) const
+-> std::vector<not_null<HistoryItem*>> {
+	auto result = std::vector<not_null<HistoryItem*>>();
+	auto merge = false;
+	for (auto i = _words.lower_bound(prefix); i != end(_words); ++i) {
+		if (!i->first.startsWith(prefix)) {
+			break;
+		}
+		merge = !result.empty();
+		result.insert(end(result), begin(i->second), end(i->second));
+	}
+	if (merge) {
+		ranges::sort(result);
+		result.erase(ranges::unique(result), end(result));
+	}
+	return result;
+}
+
+std::vector<not_null<HistoryItem*>> MessagesSearchIndex::search(
+		const QString &query,
+		History *inHistory,
+		PeerData *from,
+		int limit) const {
+	const auto words = TextUtilities::PrepareSearchWords(query);
+	if (words.isEmpty() || limit <= 0) {
+		return {};
+	}
+	using Found = std::vector<not_null<HistoryItem*>>;
+	auto found = std::optional<Found>();
+	for (const auto &word : words) {
+		auto matched = collect(word);
+		if (found) {
+			auto both = Found();
+			ranges::set_intersection(
+				*found,
+				matched,
+				std::back_inserter(both));
+			matched = std::move(both);
+		}
+		if (matched.empty()) {
+			return {};
+		}
+		found = std::move(matched);
+	}
+
+	auto result = std::vector<not_null<HistoryItem*>>();
+	for (const auto item : *found) {
+		if (!IsServerMsgId(item->id)
+			|| (inHistory && item->history() != inHistory)
+			|| (from && item->from() != from)) {
+			continue;
+		}
+		result.push_back(item);
+	}
+	ranges::sort(result, ranges::greater(), [](not_null<HistoryItem*> item) {
+		return std::make_pair(item->date(), item->id);
+	});
+	if (int(result.size()) > limit) {
+		result.erase(begin(result) + limit, end(result));
+	}
+	return result;
+}
+
+int64 MessagesSearchIndex::memoryUsage() const {
+	return _memoryUsage;
+}
+
+} // namespace Data
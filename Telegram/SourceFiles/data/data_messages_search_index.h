@@ -0,0 +1,50 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class History;
+class HistoryItem;
+class PeerData;
+
+namespace Data {
+
+// Inverted index of the words of all the messages in memory,
+// to show the local results while the server search is being done.
+//
+// The words are normalized by TextUtilities::PrepareSearchWords(), the
+// same way as the search queries. Each query word matches the indexed
+// words it is a prefix of and all query words must match.
+class MessagesSearchIndex final {
+public:
+	void update(not_null<HistoryItem*> item, const QString &text);
+	void remove(not_null<HistoryItem*> item);
+
+	[[nodiscard]] std::vector<not_null<HistoryItem*>> search(
+		const QString &query,
+		History *inHistory,
+		PeerData *from,
+		int limit) const;
+
+	[[nodiscard]] int64 memoryUsage() const;
+
+private:
+	// Popular words are in too many messages for a flat_set.
+	using Items = std::set<not_null<HistoryItem*>>;
+
+	// Sorted and without duplicates.
+	[[nodiscard]] std::vector<not_null<HistoryItem*>> collect(
+		const QString &prefix) const;
+
+	std::map<QString, Items> _words;
+	std::unordered_map<not_null<HistoryItem*>, QStringList> _itemWords;
+	int64 _memoryUsage = 0;
+	bool _limitReported = false;
+
+};
+
+} // namespace Data
@@ -84,6 +84,24 @@ PeerId FakePeerIdForJustName(const QString &name) {
 		: base::crc32(name.constData(), name.size() * sizeof(QChar)));
 }
 
+bool NameWordsHavePrefix(
+		const base::flat_set<QString> &nameWords,
+		const QString &prefix) {
+	const auto i = nameWords.lower_bound(prefix);
+	return (i != nameWords.end()) && i->startsWith(prefix);
+}
+
+bool NameWordsMatch(
+		const base::flat_set<QString> &nameWords,
+		const QStringList &queryWords) {
+	for (const auto &word : queryWords) {
+		if (!NameWordsHavePrefix(nameWords, word)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 bool UpdateBotCommands(
 		std::vector<BotCommand> &commands,
 		const MTPVector<MTPBotCommand> &data) {
@@ -595,8 +613,6 @@ void PeerData::setSettings(const MTPPeerSettings &data) {
 }
 
 void PeerData::fillNames() {
-	_nameWords.clear();
-	_nameFirstLetters.clear();
 	auto toIndexList = QStringList();
 	auto appendToIndex = [&](const QString &value) {
 		if (!value.isEmpty()) {
@@ -637,9 +653,12 @@ void PeerData::fillNames() {
 	toIndex += ' ' + rusKeyboardLayoutSwitch(toIndex);
 
 	const auto namesList = TextUtilities::PrepareSearchWords(toIndex);
-	for (const auto &name : namesList) {
-		_nameWords.insert(name);
-		_nameFirstLetters.insert(name[0]);
+	_nameWords = base::flat_set<QString>(
+		namesList.begin(),
+		namesList.end());
+	_nameFirstLetters.clear();
+	for (const auto &name : _nameWords) {
+		_nameFirstLetters.emplace(name[0]);
 	}
 }
 
@@ -112,6 +112,15 @@ int PeerColorIndex(BareId bareId);
 style::color PeerUserpicColor(PeerId peerId);
 PeerId FakePeerIdForJustName(const QString &name);
 
+// Name words are normalized by TextUtilities::PrepareSearchWords() and
+// sorted, so the only candidate for a prefix is the first word not less.
+[[nodiscard]] bool NameWordsHavePrefix(
+	const base::flat_set<QString> &nameWords,
+	const QString &prefix);
+[[nodiscard]] bool NameWordsMatch(
+	const base::flat_set<QString> &nameWords,
+	const QStringList &queryWords);
+
 class RestrictionCheckResult {
 public:
 	[[nodiscard]] static RestrictionCheckResult Allowed() {
@@ -12,8 +12,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_messages.h"
 #include "data/data_channel.h"
 #include "data/data_histories.h"
+#include "data/data_document.h"
+#include "data/data_media_types.h"
 #include "history/history.h"
 #include "history/history_item.h"
+#include "ui/text/text_utilities.h"
 #include "apiwrap.h"
 
 namespace Api {
@@ -21,6 +24,39 @@ namespace {
 
 constexpr auto kSharedMediaLimit = 100;
 constexpr auto kDefaultSearchTimeoutMs = crl::time(200);
+constexpr auto kResultsCacheLifetime = 5 * 60 * crl::time(1000);
+constexpr auto kResultsCacheLimit = 64;
+constexpr auto kLogResultsCacheStatsEach = 100;
+
+[[nodiscard]] QString SearchableText(not_null<HistoryItem*> item) {
+	auto result = item->originalText().text;
+	const auto media = item->media();
+	if (const auto document = media ? media->document() : nullptr) {
+		result += ' ' + document->filename();
+		if (const auto song = document->song()) {
+			result += ' ' + song->performer + ' ' + song->title;
+		}
+	}
+	return result;
+}
+
+// Same as the server does it: each query word is a prefix of some word.
+[[nodiscard]] bool MatchesSearchWords(
+		not_null<HistoryItem*> item,
+		const QStringList &words) {
+	const auto itemWords = TextUtilities::PrepareSearchWords(
+		SearchableText(item));
+	for (const auto &word : words) {
+		const auto found = ranges::any_of(itemWords, [&](
+				const QString &itemWord) {
+			return itemWord.startsWith(word);
+		});
+		if (!found) {
+			return false;
+		}
+	}
+	return true;
+}
 
 } // namespace
 
@@ -189,6 +225,120 @@ SearchResult ParseSearchResult(
 	return result;
 }
 
+auto SearchResultsCache::lookup(const Key &key) -> Entry* {
+	const auto i = _entries.find(key);
+	if (i == end(_entries)) {
+		return nullptr;
+	}
+	const auto now = crl::now();
+	if (i->second.received + kResultsCacheLifetime <= now) {
+		_entries.erase(i);
+		return nullptr;
+	}
+	i->second.used = now;
+	return &i->second;
+}
+
+void SearchResultsCache::add(const Key &key, const SearchResult &result) {
+	auto entry = lookup(key);
+	if (!entry) {
+		if (int(_entries.size()) >= kResultsCacheLimit) {
+			const auto oldest = ranges::min_element(
+				_entries,
+				ranges::less(),
+				[](const auto &pair) { return pair.second.used; });
+			_entries.erase(oldest);
+		}
+		const auto now = crl::now();
+		entry = &_entries.emplace(
+			key,
+			Entry{ .received = now, .used = now }).first->second;
+	}
+	entry->results.push_back(result);
+}
+
+bool SearchResultsCache::contains(const Key &key) {
+	return lookup(key) != nullptr;
+}
+
+const std::vector<SearchResult> *SearchResultsCache::find(const Key &key) {
+	const auto entry = lookup(key);
+	return entry ? &entry->results : nullptr;
+}
+
+std::optional<std::vector<MsgId>> SearchResultsCache::findComplete(
+		const Key &key) {
+	const auto entry = lookup(key);
+	if (!entry || entry->results.empty()) {
+		return std::nullopt;
+	}
+	auto ids = base::flat_set<MsgId>();
+	for (const auto &result : entry->results) {
+		ids.merge(begin(result.messageIds), end(result.messageIds));
+	}
+	if (int(ids.size()) < entry->results.back().fullCount) {
+		return std::nullopt;
+	}
+	return std::vector<MsgId>(begin(ids), end(ids));
+}
+
+void SearchResultsCache::removeOne(PeerId peerId, MsgId messageId) {
+	for (auto &[key, entry] : _entries) {
+		if (key.peerId != peerId) {
+			continue;
+		}
+		for (auto &result : entry.results) {
+			const auto i = ranges::find(result.messageIds, messageId);
+			if (i != end(result.messageIds)) {
+				result.messageIds.erase(i);
+				if (result.fullCount > 0) {
+					--result.fullCount;
+				}
+			}
+		}
+	}
+}
+
+void SearchResultsCache::removePeer(PeerId peerId) {
+	for (auto i = begin(_entries); i != end(_entries);) {
+		if (i->first.peerId == peerId) {
+			i = _entries.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+void SearchResultsCache::countHit() {
+	++_stats.hits;
+	checkLogStats();
+}
+
+void SearchResultsCache::countNarrowed() {
+	++_stats.narrowed;
+	checkLogStats();
+}
+
+void SearchResultsCache::countMiss() {
+	++_stats.misses;
+	checkLogStats();
+}
+
+void SearchResultsCache::checkLogStats() {
+	const auto total = _stats.hits + _stats.narrowed + _stats.misses;
+	if (total < kLogResultsCacheStatsEach) {
+		return;
+	}
+	DEBUG_LOG(("Search Cache: %1 queries, %2 hits, %3 narrowed, %4 misses, "
+		"%5 entries"
+		).arg(total
+		).arg(_stats.hits
+		).arg(_stats.narrowed
+		).arg(_stats.misses
+		).arg(_entries.size()));
+	_stats = Stats();
+}
+
 SearchController::CacheEntry::CacheEntry(
 	not_null<Main::Session*> session,
 	const Query &query)
@@ -203,20 +353,151 @@ SearchController::SearchController(not_null<Main::Session*> session)
 }
 
 bool SearchController::hasInCache(const Query &query) const {
-	return query.query.isEmpty() || _cache.contains(query);
+	if (query.query.isEmpty()) {
+		return true;
+	}
+	const auto i = _cache.find(query);
+	if (i != _cache.end()) {
+		return !i->second->narrowed;
+	}
+	return _session->api().searchResultsCache().contains({
+		query.peerId,
+		query.type,
+		query.query,
+	});
 }
 
 void SearchController::setQuery(const Query &query) {
+	if (_current != _cache.end() && _current->first != query) {
+		cancelRequests();
+	}
 	if (query.query.isEmpty()) {
 		_cache.clear();
 		_current = _cache.end();
 	} else {
 		_current = _cache.find(query);
+		if (_current != _cache.end() && _current->second->narrowed) {
+			_cache.erase(_current);
+			_current = _cache.end();
+		}
 	}
 	if (_current == _cache.end()) {
 		_current = _cache.emplace(
 			query,
 			std::make_unique<CacheEntry>(_session, query)).first;
+		if (!query.query.isEmpty()) {
+			auto &cache = _session->api().searchResultsCache();
+			if (applyCached(query, _current->second.get())) {
+				cache.countHit();
+			} else {
+				cache.countMiss();
+			}
+		}
+	}
+}
+
+bool SearchController::setQueryNarrowed(const Query &query) {
+	if (query.query.isEmpty() || _cache.contains(query)) {
+		return false;
+	}
+	auto ids = narrow(query, query.peerId);
+	if (!ids) {
+		return false;
+	}
+	auto migratedIds = std::optional<std::vector<MsgId>>();
+	if (query.migratedPeerId) {
+		migratedIds = narrow(query, query.migratedPeerId);
+		if (!migratedIds) {
+			return false;
+		}
+	}
+	if (_current != _cache.end()) {
+		cancelRequests();
+	}
+	auto entry = std::make_unique<CacheEntry>(_session, query);
+	entry->narrowed = true;
+	const auto count = int(ids->size());
+	entry->peerData.list.addSlice(
+		std::move(*ids),
+		{ 0, ServerMaxMsgId },
+		count);
+	if (migratedIds) {
+		const auto count = int(migratedIds->size());
+		entry->migratedData->list.addSlice(
+			std::move(*migratedIds),
+			{ 0, ServerMaxMsgId },
+			count);
+	}
+	_current = _cache.emplace(query, std::move(entry)).first;
+	_session->api().searchResultsCache().countNarrowed();
+	return true;
+}
+
+bool SearchController::applyCached(
+		const Query &query,
+		not_null<CacheEntry*> entry) {
+	auto &cache = _session->api().searchResultsCache();
+	const auto apply = [&](PeerId peerId, Data &data) {
+		const auto results = cache.find({ peerId, query.type, query.query });
+		if (!results) {
+			return false;
+		}
+		for (const auto &result : *results) {
+			auto ids = result.messageIds;
+			data.list.addSlice(
+				std::move(ids),
+				result.noSkipRange,
+				result.fullCount);
+		}
+		return true;
+	};
+	const auto found = apply(query.peerId, entry->peerData);
+	if (found && entry->migratedData) {
+		apply(query.migratedPeerId, *entry->migratedData);
+	}
+	return found;
+}
+
+std::optional<std::vector<MsgId>> SearchController::narrow(
+		const Query &query,
+		PeerId peerId) const {
+	auto &cache = _session->api().searchResultsCache();
+	const auto words = TextUtilities::PrepareSearchWords(query.query);
+	if (words.isEmpty()) {
+		return std::nullopt;
+	}
+	const auto channelId = peerToChannel(peerId);
+	for (auto length = query.query.size() - 1; length > 0; --length) {
+		const auto found = cache.findComplete({
+			peerId,
+			query.type,
+			query.query.mid(0, length),
+		});
+		if (!found) {
+			continue;
+		}
+		auto result = std::vector<MsgId>();
+		result.reserve(found->size());
+		for (const auto id : *found) {
+			const auto item = _session->data().message(channelId, id);
+			if (!item) {
+				return std::nullopt;
+			} else if (MatchesSearchWords(item, words)) {
+				result.push_back(id);
+			}
+		}
+		return result;
+	}
+	return std::nullopt;
+}
+
+void SearchController::cancelRequests() {
+	Expects(_current != _cache.end());
+
+	const auto entry = _current->second.get();
+	entry->peerData.requests.clear();
+	if (entry->migratedData) {
+		entry->migratedData->requests.clear();
 	}
 }
 
@@ -386,6 +667,9 @@ void SearchController::requestMore(
 				key.aroundId,
 				key.direction,
 				result);
+			_session->api().searchResultsCache().add(
+				{ listData->peer->id, query.type, query.query },
+				parsed);
 			listData->list.addSlice(
 				std::move(parsed.messageIds),
 				parsed.noSkipRange,
@@ -413,13 +697,17 @@ void DelayedSearchController::setQuery(const Query &query) {
 void DelayedSearchController::setQuery(
 		const Query &query,
 		crl::time delay) {
-	if (currentQuery() == query) {
+	const auto same = (currentQuery() == query);
+	if (same && !_controller.queryNarrowed()) {
 		_timer.cancel();
 		return;
 	}
 	if (_controller.hasInCache(query)) {
 		setQueryFast(query);
 	} else {
+		if (!same && _controller.setQueryNarrowed(query)) {
+			_currentQueryChanges.fire_copy(query.query);
+		}
 		_nextQuery = query;
 		_timer.callOnce(delay);
 	}
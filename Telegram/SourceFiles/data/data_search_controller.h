@@ -44,6 +44,59 @@ SearchResult ParseSearchResult(
 	Data::LoadDirection direction,
 	const MTPmessages_Messages &data);
 
+// Recent server answers, shared by all the search controllers of a session.
+class SearchResultsCache final {
+public:
+	struct Key {
+		PeerId peerId = 0;
+		Storage::SharedMediaType type = Storage::SharedMediaType::kCount;
+		QString query;
+
+		friend inline auto value_ordering_helper(const Key &value) {
+			return std::tie(
+				value.peerId,
+				value.type,
+				value.query);
+		}
+
+	};
+
+	void add(const Key &key, const SearchResult &result);
+	[[nodiscard]] bool contains(const Key &key);
+	[[nodiscard]] const std::vector<SearchResult> *find(const Key &key);
+
+	// All the found ids, if the server answer was received in full.
+	[[nodiscard]] std::optional<std::vector<MsgId>> findComplete(
+		const Key &key);
+
+	// Results don't follow the history changes by themselves.
+	void removeOne(PeerId peerId, MsgId messageId);
+	void removePeer(PeerId peerId);
+
+	void countHit();
+	void countNarrowed();
+	void countMiss();
+
+private:
+	struct Stats {
+		int hits = 0;
+		int narrowed = 0;
+		int misses = 0;
+	};
+	struct Entry {
+		std::vector<SearchResult> results;
+		crl::time received = 0;
+		crl::time used = 0;
+	};
+
+	[[nodiscard]] Entry *lookup(const Key &key);
+	void checkLogStats();
+
+	base::flat_map<Key, Entry> _entries;
+	Stats _stats;
+
+};
+
 class SearchController final {
 public:
 	using IdsList = Storage::SparseIdsList;
@@ -75,10 +128,17 @@ public:
 	void setQuery(const Query &query);
 	bool hasInCache(const Query &query) const;
 
+	// Shows the cached results of a shorter query, filtered locally,
+	// until the next setQuery() with the server answer.
+	bool setQueryNarrowed(const Query &query);
+
 	Query query() const {
 		Expects(_current != _cache.cend());
 		return _current->first;
 	}
+	bool queryNarrowed() const {
+		return (_current != _cache.cend()) && _current->second->narrowed;
+	}
 
 	rpl::producer<SparseIdsMergedSlice> idsSlice(
 		SparseIdsMergedSlice::UniversalMsgId aroundId,
@@ -106,6 +166,7 @@ private:
 
 		Data peerData;
 		std::optional<Data> migratedData;
+		bool narrowed = false;
 	};
 
 	struct CacheLess {
@@ -128,6 +189,11 @@ private:
 		const SparseIdsSliceBuilder::AroundData &key,
 		const Query &query,
 		Data *listData);
+	bool applyCached(const Query &query, not_null<CacheEntry*> entry);
+	[[nodiscard]] std::optional<std::vector<MsgId>> narrow(
+		const Query &query,
+		PeerId peerId) const;
+	void cancelRequests();
 
 	const not_null<Main::Session*> _session;
 	Cache _cache;
@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwidget.h"
 #include "api/api_text_entities.h"
 #include "core/application.h"
+#include "core/core_startup_trace.h"
 #include "core/mime_type.h" // Core::IsMimeSticker
 #include "core/crash_reports.h" // CrashReports::SetAnnotation
 #include "ui/image/image.h"
@@ -29,6 +30,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/history_view_send_action.h"
 #include "inline_bots/inline_bot_layout_item.h"
 #include "storage/storage_account.h"
+#include "storage/storage_cache_budget.h"
 #include "storage/storage_encrypted_file.h"
 #include "media/player/media_player_instance.h" // instance()->play()
 #include "media/audio/media_audio.h"
@@ -52,10 +54,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_poll.h"
 #include "data/data_chat_filters.h"
 #include "data/data_scheduled_messages.h"
+#include "data/data_shared_media_index.h"
 #include "data/data_cloud_themes.h"
 #include "data/data_streaming.h"
 #include "data/data_media_rotation.h"
 #include "data/data_histories.h"
+#include "data/data_messages_search_index.h"
 #include "base/platform/base_platform_info.h"
 #include "base/unixtime.h"
 #include "base/call_delayed.h"
@@ -210,6 +214,24 @@ std::vector<UnavailableReason> ExtractUnavailableReasons(
 			double(std::numeric_limits<int>::max())));
 }
 
+[[nodiscard]] std::vector<Storage::CacheBudget::Quota> CacheQuotas() {
+	return {
+		{ .tag = kImageCacheTag, .percent = 60 },
+		{ .tag = kStickerCacheTag, .percent = 40 },
+		{ .tag = kVoiceMessageCacheTag, .percent = 40 },
+		{ .tag = kVideoMessageCacheTag, .percent = 40 },
+		{ .tag = kAnimationCacheTag, .percent = 40 },
+	};
+}
+
+[[nodiscard]] std::vector<Storage::CacheBudget::Quota> BigFileQuotas() {
+	// Leave room for the animated sticker frames even with long videos.
+	return {
+		{ .tag = kStreamingCacheTag, .percent = 80 },
+		{ .tag = kLottieFramesCacheTag, .percent = 40 },
+	};
+}
+
 } // namespace
 
 Session::Session(not_null<Main::Session*> session)
@@ -220,6 +242,14 @@ Session::Session(not_null<Main::Session*> session)
 , _bigFileCache(Core::App().databases().get(
 	_session->local().cacheBigFilePath(),
 	_session->local().cacheBigFileSettings()))
+, _cacheBudget(std::make_unique<Storage::CacheBudget>(
+	_cache.get(),
+	_session->local().cacheSettings().totalSizeLimit,
+	CacheQuotas()))
+, _bigFileCacheBudget(std::make_unique<Storage::CacheBudget>(
+	_bigFileCache.get(),
+	_session->local().cacheBigFileSettings().totalSizeLimit,
+	BigFileQuotas()))
 , _chatsList(
 	session,
 	FilterId(),
@@ -236,9 +266,11 @@ Session::Session(not_null<Main::Session*> session)
 , _groups(this)
 , _chatsFilters(std::make_unique<ChatFilters>(this))
 , _scheduledMessages(std::make_unique<ScheduledMessages>(this))
+, _sharedMediaIndex(std::make_unique<SharedMediaIndex>(this))
 , _cloudThemes(std::make_unique<CloudThemes>(session))
 , _streaming(std::make_unique<Streaming>(this))
 , _mediaRotation(std::make_unique<MediaRotation>())
+, _messagesSearchIndex(std::make_unique<MessagesSearchIndex>())
 , _histories(std::make_unique<Histories>(this))
 , _stickers(std::make_unique<Stickers>(this)) {
 	_cache->open(_session->local().cacheKey());
@@ -257,7 +289,7 @@ Session::Session(not_null<Main::Session*> session)
 	setupPeerNameViewer();
 	setupUserIsContactViewer();
 
-	_chatsList.unreadStateChanges(
+	_chatsList.unreadStateUpdates(
 	) | rpl::start_with_next([=] {
 		notifyUnreadBadgeChanged();
 	}, _lifetime);
@@ -279,6 +311,7 @@ void Session::clear() {
 
 	_sendActions.clear();
 
+	_sharedMediaIndex->finish();
 	_histories->unloadAll();
 	_scheduledMessages = nullptr;
 	_dependentMessages.clear();
@@ -290,6 +323,7 @@ void Session::clear() {
 	cSetRecentStickers(RecentStickerPack());
 	App::clearMousedItems();
 	_histories->clearAll();
+	_messagesSearchIndex = std::make_unique<MessagesSearchIndex>();
 	_webpages.clear();
 	_locations.clear();
 	_polls.clear();
@@ -849,6 +883,32 @@ PeerData *Session::processChats(const MTPVector<MTPChat> &data) {
 	return result;
 }
 
+void Session::processCachedUsers(const MTPVector<MTPUser> &data) {
+	for (const auto &user : data.v) {
+		const auto id = user.match([](const auto &data) {
+			return peerFromUser(data.vid());
+		});
+		if (!peerLoaded(id)) {
+			processUser(user);
+		}
+	}
+}
+
+void Session::processCachedChats(const MTPVector<MTPChat> &data) {
+	for (const auto &chat : data.v) {
+		const auto id = chat.match([](const MTPDchannel &data) {
+			return peerFromChannel(data.vid());
+		}, [](const MTPDchannelForbidden &data) {
+			return peerFromChannel(data.vid());
+		}, [](const auto &data) {
+			return peerFromChat(data.vid());
+		});
+		if (!peerLoaded(id)) {
+			processChat(chat);
+		}
+	}
+}
+
 void Session::applyMaximumChatVersions(const MTPVector<MTPChat> &data) {
 	for (const auto &chat : data.v) {
 		chat.match([&](const MTPDchat &data) {
@@ -1131,6 +1191,19 @@ void Session::chatsListDone(Data::Folder *folder) {
 	_chatsListLoadedEvents.fire_copy(folder);
 }
 
+void Session::chatsListPainted() {
+	if (_chatsListPainted) {
+		return;
+	}
+	_chatsListPainted = true;
+	Core::StartupTraceInstant("First chat list paint");
+	Core::FinishStartupTrace();
+	LOG(("Startup: chat list first painted in %1 ms, %2 chats, %3."
+		).arg(crl::now() - _createdAt
+		).arg(_chatsList.indexed()->size()
+		).arg(_chatsList.loaded() ? "loaded" : "loading"));
+}
+
 void Session::userIsBotChanged(not_null<UserData*> user) {
 	if (const auto history = this->history(user)) {
 		chatsFilters().refreshHistory(history);
@@ -1158,6 +1231,14 @@ Storage::Cache::Database &Session::cacheBigFile() {
 	return *_bigFileCache;
 }
 
+Storage::CacheBudget &Session::cacheBudget() {
+	return *_cacheBudget;
+}
+
+Storage::CacheBudget &Session::cacheBigFileBudget() {
+	return *_bigFileCacheBudget;
+}
+
 void Session::suggestStartExport(TimeId availableAt) {
 	_exportAvailableAt = availableAt;
 	suggestStartExport();
@@ -2098,6 +2179,7 @@ void Session::unregisterMessage(not_null<HistoryItem*> item) {
 		Data::MessageUpdate::Flag::Destroyed);
 	groups().unregisterMessage(item);
 	removeDependencyMessage(item);
+	_messagesSearchIndex->remove(item);
 	messagesListForInsert(peerToChannel(peerId))->erase(item->id);
 }
 
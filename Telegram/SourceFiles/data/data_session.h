@@ -27,6 +27,10 @@ struct WebPageCollage;
 enum class WebPageType;
 enum class NewMessageType;
 
+namespace Storage {
+class CacheBudget;
+} // namespace Storage
+
 namespace HistoryView {
 struct Group;
 class Element;
@@ -52,11 +56,13 @@ class Folder;
 class LocationPoint;
 class WallPaper;
 class ScheduledMessages;
+class SharedMediaIndex;
 class ChatFilters;
 class CloudThemes;
 class Streaming;
 class MediaRotation;
 class Histories;
+class MessagesSearchIndex;
 class DocumentMedia;
 class PhotoMedia;
 class Stickers;
@@ -92,6 +98,9 @@ public:
 	[[nodiscard]] ScheduledMessages &scheduledMessages() const {
 		return *_scheduledMessages;
 	}
+	[[nodiscard]] SharedMediaIndex &sharedMediaIndex() const {
+		return *_sharedMediaIndex;
+	}
 	[[nodiscard]] CloudThemes &cloudThemes() const {
 		return *_cloudThemes;
 	}
@@ -104,6 +113,9 @@ public:
 	[[nodiscard]] Histories &histories() const {
 		return *_histories;
 	}
+	[[nodiscard]] MessagesSearchIndex &messagesSearchIndex() const {
+		return *_messagesSearchIndex;
+	}
 	[[nodiscard]] Stickers &stickers() const {
 		return *_stickers;
 	}
@@ -128,6 +140,8 @@ public:
 
 	[[nodiscard]] Storage::Cache::Database &cache();
 	[[nodiscard]] Storage::Cache::Database &cacheBigFile();
+	[[nodiscard]] Storage::CacheBudget &cacheBudget();
+	[[nodiscard]] Storage::CacheBudget &cacheBigFileBudget();
 
 	[[nodiscard]] not_null<PeerData*> peer(PeerId id);
 	[[nodiscard]] not_null<PeerData*> peer(UserId id) = delete;
@@ -154,6 +168,10 @@ public:
 	UserData *processUsers(const MTPVector<MTPUser> &data);
 	PeerData *processChats(const MTPVector<MTPChat> &data);
 
+	// Locally cached users and chats never overwrite the loaded ones.
+	void processCachedUsers(const MTPVector<MTPUser> &data);
+	void processCachedChats(const MTPVector<MTPChat> &data);
+
 	void applyMaximumChatVersions(const MTPVector<MTPChat> &data);
 
 	void registerGroupCall(not_null<GroupCall*> call);
@@ -212,6 +230,7 @@ public:
 	void chatsListChanged(FolderId folderId);
 	void chatsListChanged(Data::Folder *folder);
 	void chatsListDone(Data::Folder *folder);
+	void chatsListPainted();
 
 	void userIsBotChanged(not_null<UserData*> user);
 	[[nodiscard]] rpl::producer<not_null<UserData*>> userIsBotChanges() const;
@@ -823,12 +842,16 @@ private:
 
 	Storage::DatabasePointer _cache;
 	Storage::DatabasePointer _bigFileCache;
+	const std::unique_ptr<Storage::CacheBudget> _cacheBudget;
+	const std::unique_ptr<Storage::CacheBudget> _bigFileCacheBudget;
 
 	TimeId _exportAvailableAt = 0;
 	QPointer<Ui::BoxContent> _exportSuggestion;
 
 	rpl::variable<bool> _contactsLoaded = false;
 	rpl::event_stream<Data::Folder*> _chatsListLoadedEvents;
+	const crl::time _createdAt = crl::now();
+	bool _chatsListPainted = false;
 	rpl::event_stream<Data::Folder*> _chatsListChanged;
 	rpl::event_stream<not_null<UserData*>> _userIsBotChanges;
 	rpl::event_stream<not_null<PeerData*>> _botCommandsChanges;
@@ -979,9 +1002,11 @@ private:
 	Groups _groups;
 	std::unique_ptr<ChatFilters> _chatsFilters;
 	std::unique_ptr<ScheduledMessages> _scheduledMessages;
+	std::unique_ptr<SharedMediaIndex> _sharedMediaIndex;
 	std::unique_ptr<CloudThemes> _cloudThemes;
 	std::unique_ptr<Streaming> _streaming;
 	std::unique_ptr<MediaRotation> _mediaRotation;
+	std::unique_ptr<MessagesSearchIndex> _messagesSearchIndex;
 	std::unique_ptr<Histories> _histories;
 	base::flat_map<
 		not_null<History*>,
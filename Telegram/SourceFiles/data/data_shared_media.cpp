@@ -22,6 +22,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_scheduled_messages.h"
 #include "data/data_sparse_ids.h"
 #include "data/data_session.h"
+#include "data/data_shared_media_index.h"
 #include "info/info_memento.h"
 #include "info/info_controller.h"
 #include "window/window_session_controller.h"
@@ -145,8 +146,58 @@ rpl::producer<SparseIdsSlice> SharedMediaViewer(
 		builder->insufficientAround(
 		) | rpl::start_with_next(requestMediaAround, lifetime);
 
+		// Ids restored from the local index may have no loaded messages.
+		const auto guard = lifetime.make_state<base::has_weak_ptr>();
+		const auto requested = lifetime.make_state<base::flat_set<MsgId>>();
+		const auto repushScheduled = lifetime.make_state<bool>(false);
+		const auto repush = [=] {
+			if (*repushScheduled) {
+				return;
+			}
+			*repushScheduled = true;
+			crl::on_main(guard, [=] {
+				*repushScheduled = false;
+				consumer.put_next(builder->snapshot());
+			});
+		};
+		const auto loaded = [=](ChannelId channelId, MsgId id, bool answered) {
+			// It could be deleted while we were offline.
+			if (answered && !session->data().message(channelId, id)) {
+				session->storage().remove(Storage::SharedMediaRemoveOne(
+					key.peerId,
+					Storage::SharedMediaTypesMask{}.added(key.type),
+					id));
+			}
+			repush();
+		};
+		const auto requestMissing = [=](const SparseIdsSlice &slice) {
+			const auto channelId = peerToChannel(key.peerId);
+			const auto channel = channelId
+				? session->data().channelLoaded(channelId)
+				: nullptr;
+			if (channelId && !channel) {
+				return;
+			}
+			for (auto i = 0, count = slice.size(); i != count; ++i) {
+				const auto id = slice[i];
+				if (requested->contains(id)
+					|| session->data().message(channelId, id)) {
+					continue;
+				}
+				requested->emplace(id);
+				session->api().requestMessageDataResult(
+					channel,
+					id,
+					crl::guard(guard, [=](bool answered) {
+						loaded(channelId, id, answered);
+					}));
+			}
+		};
+
 		auto pushNextSnapshot = [=] {
-			consumer.put_next(builder->snapshot());
+			auto snapshot = builder->snapshot();
+			requestMissing(snapshot);
+			consumer.put_next(std::move(snapshot));
 		};
 
 		using SliceUpdate = Storage::SharedMediaSliceUpdate;
@@ -184,6 +235,8 @@ rpl::producer<SparseIdsSlice> SharedMediaViewer(
 			return builder->invalidateBottom();
 		}) | rpl::start_with_next(pushNextSnapshot, lifetime);
 
+		session->data().sharedMediaIndex().load(key.peerId);
+
 		using Result = Storage::SharedMediaResult;
 		session->storage().query(Storage::SharedMediaQuery(
 			key,
@@ -0,0 +1,196 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_shared_media_index.h"
+
+#include "data/data_session.h"
+#include "main/main_session.h"
+#include "storage/storage_facade.h"
+#include "storage/storage_shared_media.h"
+#include "storage/cache/storage_cache_database.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kSaveDelay = 5 * crl::time(1000);
+constexpr auto kSerializeVersion = qint32(1);
+constexpr auto kSharedMediaIndexCacheTag = 0x0000050000000000ULL;
+
+[[nodiscard]] Storage::Cache::Key SharedMediaIndexCacheKey(PeerId peerId) {
+	return Storage::Cache::Key{
+		kSharedMediaIndexCacheTag,
+		SerializePeerId(peerId)
+	};
+}
+
+} // namespace
+
+SharedMediaIndex::SharedMediaIndex(not_null<Session*> owner)
+: _owner(owner)
+, _saveTimer([=] { save(); }) {
+	auto &storage = _owner->session().storage();
+	storage.sharedMediaSliceUpdated(
+	) | rpl::start_with_next([=](
+			const Storage::SharedMediaSliceUpdate &update) {
+		changed(update.peerId);
+	}, _lifetime);
+
+	storage.sharedMediaOneRemoved(
+	) | rpl::start_with_next([=](
+			const Storage::SharedMediaRemoveOne &update) {
+		changed(update.peerId);
+	}, _lifetime);
+
+	storage.sharedMediaAllRemoved(
+	) | rpl::start_with_next([=](
+			const Storage::SharedMediaRemoveAll &update) {
+		changed(update.peerId);
+	}, _lifetime);
+
+	storage.sharedMediaBottomInvalidated(
+	) | rpl::start_with_next([=](
+			const Storage::SharedMediaInvalidateBottom &update) {
+		changed(update.peerId);
+	}, _lifetime);
+}
+
+SharedMediaIndex::~SharedMediaIndex() {
+	finish();
+}
+
+void SharedMediaIndex::load(PeerId peerId) {
+	if (_finished || !peerId || _loadRequested.contains(peerId)) {
+		return;
+	}
+	_loadRequested.emplace(peerId);
+
+	const auto guard = base::make_weak(&_owner->session());
+	_owner->cache().get(SharedMediaIndexCacheKey(peerId), [=](
+			QByteArray value) {
+		crl::on_main(guard, [=] {
+			apply(peerId, value);
+		});
+	});
+}
+
+void SharedMediaIndex::apply(PeerId peerId, const QByteArray &serialized) {
+	if (_loaded.contains(peerId)) {
+		return;
+	}
+	_loaded.emplace(peerId);
+	if (serialized.isEmpty()) {
+		return;
+	}
+	auto stream = QDataStream(serialized);
+	stream.setVersion(QDataStream::Qt_5_1);
+	auto version = qint32();
+	auto count = qint32();
+	stream >> version >> count;
+	if (stream.status() != QDataStream::Ok
+		|| version != kSerializeVersion
+		|| count < 0
+		|| count > Storage::kSharedMediaTypeCount) {
+		return;
+	}
+	auto lists = std::vector<std::pair<Storage::SharedMediaType, QByteArray>>();
+	lists.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		auto type = qint32();
+		auto list = QByteArray();
+		stream >> type >> list;
+		const auto good = (stream.status() == QDataStream::Ok)
+			&& Storage::IsValidSharedMediaType(
+				static_cast<Storage::SharedMediaType>(type));
+		if (!good) {
+			return;
+		}
+		lists.emplace_back(
+			static_cast<Storage::SharedMediaType>(type),
+			std::move(list));
+	}
+
+	// Lists are merged with whatever was already received from the server.
+	_restoring = true;
+	auto &storage = _owner->session().storage();
+	for (const auto &[type, list] : lists) {
+		storage.restore(peerId, type, list);
+	}
+	_restoring = false;
+}
+
+void SharedMediaIndex::changed(PeerId peerId) {
+	if (_restoring) {
+		return;
+	}
+	_changed.emplace(peerId);
+
+	// Don't overwrite the saved ids before they were merged in.
+	load(peerId);
+
+	if (!_saveTimer.isActive()) {
+		_saveTimer.callOnce(kSaveDelay);
+	}
+}
+
+void SharedMediaIndex::save() {
+	auto &storage = _owner->session().storage();
+	auto &cache = _owner->cache();
+	for (auto i = _changed.begin(); i != _changed.end();) {
+		const auto peerId = *i;
+		if (!_loaded.contains(peerId)) {
+			++i;
+			continue;
+		}
+		i = _changed.erase(i);
+
+		auto lists = std::vector<std::pair<qint32, QByteArray>>();
+		auto size = 2 * int(sizeof(qint32));
+		const auto types = Storage::kSharedMediaTypeCount;
+		for (auto index = 0; index != types; ++index) {
+			const auto type = static_cast<Storage::SharedMediaType>(index);
+			auto list = storage.serialize(peerId, type);
+			if (!list.isEmpty()) {
+				size += 2 * int(sizeof(qint32)) + list.size();
+				lists.emplace_back(qint32(index), std::move(list));
+			}
+		}
+		const auto key = SharedMediaIndexCacheKey(peerId);
+		if (lists.empty()) {
+			cache.remove(key);
+			continue;
+		}
+		auto serialized = QByteArray();
+		serialized.reserve(size);
+		{
+			auto stream = QDataStream(&serialized, QIODevice::WriteOnly);
+			stream.setVersion(QDataStream::Qt_5_1);
+			stream << kSerializeVersion << qint32(lists.size());
+			for (const auto &[type, list] : lists) {
+				stream << type << list;
+			}
+		}
+		cache.put(key, Storage::Cache::Database::TaggedValue(
+			std::move(serialized),
+			0));
+	}
+	if (!_changed.empty()) {
+		_saveTimer.callOnce(kSaveDelay);
+	}
+}
+
+void SharedMediaIndex::finish() {
+	if (_finished) {
+		return;
+	}
+	_finished = true;
+	_lifetime.destroy();
+	save();
+	_saveTimer.cancel();
+	_changed.clear();
+}
+
+} // namespace Data
@@ -0,0 +1,48 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/timer.h"
+
+namespace Data {
+
+class Session;
+
+// Keeps the known shared media ids of each chat in the cache database,
+// so that after a restart the media sections don't start from scratch.
+class SharedMediaIndex final {
+public:
+	explicit SharedMediaIndex(not_null<Session*> owner);
+	SharedMediaIndex(const SharedMediaIndex &other) = delete;
+	SharedMediaIndex &operator=(const SharedMediaIndex &other) = delete;
+	~SharedMediaIndex();
+
+	void load(PeerId peerId);
+
+	// Writes all pending changes and stops tracking the storage.
+	void finish();
+
+private:
+	void changed(PeerId peerId);
+	void apply(PeerId peerId, const QByteArray &serialized);
+	void save();
+
+	const not_null<Session*> _owner;
+
+	base::flat_set<PeerId> _loadRequested;
+	base::flat_set<PeerId> _loaded;
+	base::flat_set<PeerId> _changed;
+	base::Timer _saveTimer;
+	bool _restoring = false;
+	bool _finished = false;
+
+	rpl::lifetime _lifetime;
+
+};
+
+} // namespace Data
@@ -59,6 +59,10 @@ constexpr auto kVoiceMessageCacheTag = uint8(0x03);
 constexpr auto kVideoMessageCacheTag = uint8(0x04);
 constexpr auto kAnimationCacheTag = uint8(0x05);
 
+// Used in the big files cache database.
+constexpr auto kStreamingCacheTag = uint8(0x06);
+constexpr auto kLottieFramesCacheTag = uint8(0x07);
+
 struct FileOrigin;
 
 } // namespace Data
@@ -129,13 +129,20 @@ InnerWidget::InnerWidget(
 
 	session().downloaderTaskFinished(
 	) | rpl::start_with_next([=] {
+		Layout::ClearRowsCache();
 		update();
 	}, lifetime());
 
+	style::PaletteChanged(
+	) | rpl::start_with_next([=] {
+		Layout::ClearRowsCache();
+	}, lifetime());
+
 	Core::App().notifications().settingsChanged(
 	) | rpl::start_with_next([=](Window::Notifications::ChangeType change) {
 		if (change == Window::Notifications::ChangeType::CountMessages) {
 			// Folder rows change their unread badge with this setting.
+			Layout::ClearRowsCache();
 			update();
 		}
 	}, lifetime());
@@ -220,6 +227,7 @@ InnerWidget::InnerWidget(
 			stopReorderPinned();
 		}
 		if (update.flags & Data::HistoryUpdate::Flag::ChatOccupied) {
+			Layout::ClearRowsCache();
 			this->update();
 			_updated.fire({});
 		}
@@ -232,6 +240,7 @@ InnerWidget::InnerWidget(
 		| UpdateFlag::IsContact
 	) | rpl::start_with_next([=](const Data::PeerUpdate &update) {
 		if (update.flags & (UpdateFlag::Name | UpdateFlag::Photo)) {
+			Layout::ClearRowsCache();
 			this->update();
 			_updated.fire({});
 		}
@@ -246,6 +255,7 @@ InnerWidget::InnerWidget(
 		| Data::MessageUpdate::Flag::DialogRowRefresh
 	) | rpl::start_with_next([=](const Data::MessageUpdate &update) {
 		const auto item = update.item;
+		invalidateRowCache(item->history());
 		if (update.flags & Data::MessageUpdate::Flag::DialogRowRefresh) {
 			refreshDialogRow({ item->history(), item->fullId() });
 		}
@@ -258,6 +268,7 @@ InnerWidget::InnerWidget(
 		Data::EntryUpdate::Flag::Repaint
 	) | rpl::start_with_next([=](const Data::EntryUpdate &update) {
 		const auto entry = update.entry;
+		invalidateRowCache(entry);
 		const auto repaintId = (_state == WidgetState::Default)
 			? _filterId
 			: 0;
@@ -427,6 +438,8 @@ void InnerWidget::paintEvent(QPaintEvent *e) {
 					? _selected->key()
 					: Key()));
 		if (otherStart) {
+			session().data().chatsListPainted();
+
 			const auto skip = dialogsOffset();
 			auto reorderingPinned = (_aboveIndex >= 0 && !_pinnedRows.empty());
 			if (reorderingPinned) {
@@ -1531,6 +1544,14 @@ void InnerWidget::repaintDialogRow(
 	}
 }
 
+void InnerWidget::invalidateRowCache(not_null<Entry*> entry) {
+	for (const auto filterId : { _filterId, FilterId() }) {
+		if (const auto links = entry->chatListLinks(filterId)) {
+			Layout::InvalidateRowCache(links->main);
+		}
+	}
+}
+
 void InnerWidget::repaintDialogRow(RowDescriptor row) {
 	updateDialogRow(row);
 }
@@ -1900,6 +1921,7 @@ void InnerWidget::onHashtagFilterUpdate(QStringRef newFilter) {
 
 InnerWidget::~InnerWidget() {
 	clearSearchResults();
+	Layout::ClearRowsCache();
 }
 
 void InnerWidget::clearSearchResults(bool clearPeerSearchResults) {
@@ -1967,6 +1989,13 @@ void InnerWidget::visibleTopBottomUpdated(
 }
 
 void InnerWidget::itemRemoved(not_null<const HistoryItem*> item) {
+	_localSearchResults.erase(
+		ranges::remove_if(_localSearchResults, [&](
+				not_null<HistoryItem*> local) {
+			return (local.get() == item.get());
+		}),
+		end(_localSearchResults));
+
 	int wasCount = _searchResults.size();
 	for (auto i = _searchResults.begin(); i != _searchResults.end();) {
 		if ((*i)->item() == item) {
@@ -2030,6 +2059,9 @@ bool InnerWidget::searchReceived(
 	auto isGlobalSearch = (type == SearchRequestType::FromStart || type == SearchRequestType::FromOffset);
 	auto isMigratedSearch = (type == SearchRequestType::MigratedFromStart || type == SearchRequestType::MigratedFromOffset);
 
+	// All the server results are here, local ones may be merged freely.
+	const auto complete = (messages.size() >= fullCount);
+
 	TimeId lastDateFound = 0;
 	if (inject
 		&& (!_searchInChat
@@ -2079,6 +2111,15 @@ bool InnerWidget::searchReceived(
 			_lastSearchId = msgId;
 		}
 	}
+	if (type == SearchRequestType::FromStart
+		|| type == SearchRequestType::PeerFromStart) {
+		const auto injected = (inject
+			&& !_searchResults.empty()
+			&& _searchResults.front()->item() == inject) ? 1 : 0;
+		fullCount += mergeLocalSearchResults(
+			complete ? 0 : lastDateFound,
+			injected);
+	}
 	if (isMigratedSearch) {
 		_searchedMigratedCount = fullCount;
 	} else {
@@ -2097,6 +2138,52 @@ bool InnerWidget::searchReceived(
 	return lastDateFound != 0;
 }
 
+void InnerWidget::localSearchReceived(
+		std::vector<not_null<HistoryItem*>> &&items) {
+	if (uniqueSearchResults()) {
+		return;
+	}
+	// Shown until the first page of the server results arrives,
+	// then the ones missing from that page are merged into it.
+	_localSearchResults = std::move(items);
+	clearSearchResults(false);
+	for (const auto item : _localSearchResults) {
+		_searchResults.push_back(
+			std::make_unique<FakeRow>(_searchInChat, item));
+	}
+	_searchedCount = int(_searchResults.size());
+	refresh();
+}
+
+int InnerWidget::mergeLocalSearchResults(TimeId tillDate, int skipTop) {
+	auto added = 0;
+	for (const auto item : base::take(_localSearchResults)) {
+		if (item->date() < tillDate) {
+			continue;
+		}
+		const auto i = ranges::find(
+			_searchResults,
+			item,
+			&FakeRow::item);
+		if (i != end(_searchResults)) {
+			continue;
+		}
+		_searchResults.push_back(
+			std::make_unique<FakeRow>(_searchInChat, item));
+		++added;
+	}
+	if (added) {
+		ranges::stable_sort(
+			begin(_searchResults) + skipTop,
+			end(_searchResults),
+			ranges::greater(),
+			[](const std::unique_ptr<FakeRow> &row) {
+				return row->item()->date();
+			});
+	}
+	return added;
+}
+
 void InnerWidget::peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
@@ -2384,6 +2471,7 @@ void InnerWidget::clearFilter() {
 		_filterResultsGlobal.clear();
 		_peerSearchResults.clear();
 		_searchResults.clear();
+		_localSearchResults.clear();
 		_lastSearchDate = 0;
 		_lastSearchPeer = nullptr;
 		_lastSearchId = _lastSearchMigratedId = 0;
@@ -2641,6 +2729,7 @@ void InnerWidget::switchToFilter(FilterId filterId) {
 		clearSelection();
 		stopReorderPinned();
 		_filterId = filterId;
+		Layout::ClearRowsCache();
 		refreshWithCollapsedRows(true);
 	}
 	refreshEmptyLabel();
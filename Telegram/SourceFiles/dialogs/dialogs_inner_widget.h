@@ -75,6 +75,7 @@ public:
 		HistoryItem *inject,
 		SearchRequestType type,
 		int fullCount);
+	void localSearchReceived(std::vector<not_null<HistoryItem*>> &&items);
 	void peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
@@ -187,6 +188,7 @@ private:
 		not_null<FakeRow*> result,
 		const RowDescriptor &entry) const;
 
+	void invalidateRowCache(not_null<Entry*> entry);
 	void repaintDialogRow(FilterId filterId, not_null<Row*> row);
 	void repaintDialogRow(RowDescriptor row);
 	void refreshDialogRow(RowDescriptor row);
@@ -307,6 +309,7 @@ private:
 	void refreshSearchInChatLabel();
 
 	void clearSearchResults(bool clearPeerSearchResults = true);
+	int mergeLocalSearchResults(TimeId tillDate, int skipTop);
 	void updateSelectedRow(Key key = Key());
 
 	not_null<IndexedList*> shownDialogs() const;
@@ -378,6 +381,7 @@ private:
 	int _peerSearchPressed = -1;
 
 	std::vector<std::unique_ptr<FakeRow>> _searchResults;
+	std::vector<not_null<HistoryItem*>> _localSearchResults;
 	int _searchedCount = 0;
 	int _searchedMigratedCount = 0;
 	int _searchedSelected = -1;
@@ -37,6 +37,7 @@ namespace {
 
 // Show all dates that are in the last 20 hours in time format.
 constexpr int kRecentlyInSeconds = 20 * 3600;
+constexpr auto kMaxCachedRows = 32;
 const auto kPsaBadgePrefix = "cloud_lng_badge_psa_";
 
 [[nodiscard]] bool ShowUserBotIcon(not_null<UserData*> user) {
@@ -57,25 +58,107 @@ void PaintRowTopRight(Painter &p, const QString &text, QRect &rectForName, bool
 	p.drawText(rectForName.left() + rectForName.width() + st::dialogsDateSkip, rectForName.top() + st::msgNameFont->height - st::msgDateFont->descent, text);
 }
 
-void PaintRowDate(Painter &p, QDateTime date, QRect &rectForName, bool active, bool selected) {
+[[nodiscard]] QString RowDateText(QDateTime date) {
+	if (date.isNull()) {
+		return QString();
+	}
 	const auto now = QDateTime::currentDateTime();
 	const auto &lastTime = date;
 	const auto nowDate = now.date();
 	const auto lastDate = lastTime.date();
 
-	const auto dt = [&] {
-		const auto wasSameDay = (lastDate == nowDate);
-		const auto wasRecently = qAbs(lastTime.secsTo(now)) < kRecentlyInSeconds;
-		if (wasSameDay || wasRecently) {
-			return lastTime.toString(cTimeFormat());
-		} else if (lastDate.year() == nowDate.year()
-			&& lastDate.weekNumber() == nowDate.weekNumber()) {
-			return langDayOfWeek(lastDate);
-		} else {
-			return lastDate.toString(qsl("d.MM.yy"));
-		}
-	}();
-	PaintRowTopRight(p, dt, rectForName, active, selected);
+	const auto wasSameDay = (lastDate == nowDate);
+	const auto wasRecently = qAbs(lastTime.secsTo(now)) < kRecentlyInSeconds;
+	if (wasSameDay || wasRecently) {
+		return lastTime.toString(cTimeFormat());
+	} else if (lastDate.year() == nowDate.year()
+		&& lastDate.weekNumber() == nowDate.weekNumber()) {
+		return langDayOfWeek(lastDate);
+	} else {
+		return lastDate.toString(qsl("d.MM.yy"));
+	}
+}
+
+void PaintRowDate(Painter &p, QDateTime date, QRect &rectForName, bool active, bool selected) {
+	PaintRowTopRight(p, RowDateText(date), rectForName, active, selected);
+}
+
+// Everything shown in a cached row image that can change without
+// going through Data::Changes, checked before the image is reused.
+struct RowCacheKey {
+	const Entry *entry = nullptr;
+	const HistoryItem *item = nullptr;
+	const Data::Draft *draft = nullptr;
+	QString date;
+	InMemoryKey userpic;
+	FilterId filterId = 0;
+	MsgId itemId = 0;
+	int nameVersion = 0;
+	int unreadCount = 0;
+	int fullWidth = 0;
+	bool itemUnread = false;
+	bool draftSaving = false;
+	bool active = false;
+	bool selected = false;
+	bool allowUserOnline = false;
+	bool cornerBadgeShown = false;
+	bool unreadMark = false;
+	bool unreadMuted = false;
+	bool mentionBadge = false;
+	bool pinnedIcon = false;
+
+	friend inline bool operator==(
+			const RowCacheKey &a,
+			const RowCacheKey &b) {
+		return (a.entry == b.entry)
+			&& (a.item == b.item)
+			&& (a.draft == b.draft)
+			&& (a.date == b.date)
+			&& (a.userpic == b.userpic)
+			&& (a.filterId == b.filterId)
+			&& (a.itemId == b.itemId)
+			&& (a.nameVersion == b.nameVersion)
+			&& (a.unreadCount == b.unreadCount)
+			&& (a.fullWidth == b.fullWidth)
+			&& (a.itemUnread == b.itemUnread)
+			&& (a.draftSaving == b.draftSaving)
+			&& (a.active == b.active)
+			&& (a.selected == b.selected)
+			&& (a.allowUserOnline == b.allowUserOnline)
+			&& (a.cornerBadgeShown == b.cornerBadgeShown)
+			&& (a.unreadMark == b.unreadMark)
+			&& (a.unreadMuted == b.unreadMuted)
+			&& (a.mentionBadge == b.mentionBadge)
+			&& (a.pinnedIcon == b.pinnedIcon);
+	}
+};
+
+struct RowCache {
+	RowCacheKey key;
+	QImage image;
+	uint64 lastUsed = 0;
+};
+
+// Only a few screens of rows are kept, the images are large.
+base::flat_map<const Row*, RowCache> RowsCache;
+uint64 RowsCacheUsed = 0;
+
+[[nodiscard]] not_null<RowCache*> LookupRowCache(not_null<const Row*> row) {
+	const auto i = RowsCache.find(row);
+	if (i != end(RowsCache)) {
+		i->second.lastUsed = ++RowsCacheUsed;
+		return &i->second;
+	}
+	if (int(RowsCache.size()) >= kMaxCachedRows) {
+		const auto oldest = ranges::min_element(
+			RowsCache,
+			std::less<>(),
+			[](const auto &pair) { return pair.second.lastUsed; });
+		RowsCache.erase(oldest);
+	}
+	auto &result = RowsCache[row];
+	result.lastUsed = ++RowsCacheUsed;
+	return &result;
 }
 
 void PaintNarrowCounter(
@@ -735,12 +818,72 @@ void RowPainter::paint(
 		| (allowUserOnline ? Flag::AllowUserOnline : Flag(0))
 		| (peer && peer->isSelf() ? Flag::SavedMessages : Flag(0))
 		| (peer && peer->isRepliesChat() ? Flag::RepliesMessages : Flag(0));
+
+	if (from && allowUserOnline) {
+		row->updateCornerBadgeShown(from);
+	}
+	const auto sendActionAnimating = ShowSendActionInDialogs(history)
+		&& history->sendActionPainter()->animating();
+	const auto speakingAnimating = history
+		&& allowUserOnline
+		&& !history->peer->isUser()
+		&& row->cornerBadgeShown();
+	const auto cacheable = (fullWidth > 0)
+		&& !row->folder()
+		&& !row->animating()
+		&& !sendActionAnimating
+		&& !speakingAnimating
+		&& !entry->session().supportMode()
+		&& !(history && history->useTopPromotion());
+	const auto cache = cacheable ? LookupRowCache(row) : nullptr;
+	if (cache) {
+		auto key = RowCacheKey{
+			.entry = entry,
+			.item = item,
+			.draft = cloudDraft,
+			.date = RowDateText(displayDate),
+			.userpic = from
+				? from->userpicUniqueKey(row->userpicView())
+				: InMemoryKey(),
+			.filterId = filterId,
+			.itemId = item ? item->id : MsgId(),
+			.nameVersion = from ? from->nameVersion : 0,
+			.unreadCount = unreadCount,
+			.fullWidth = fullWidth,
+			.itemUnread = item && item->unread(),
+			.draftSaving = cloudDraft && cloudDraft->saveRequestId,
+			.active = active,
+			.selected = selected,
+			.allowUserOnline = allowUserOnline,
+			.cornerBadgeShown = row->cornerBadgeShown(),
+			.unreadMark = displayUnreadMark,
+			.unreadMuted = unreadMuted,
+			.mentionBadge = displayMentionBadge,
+			.pinnedIcon = displayPinnedIcon,
+		};
+		const auto ratio = cIntRetinaFactor();
+		const auto size = QSize(fullWidth, st::dialogsRowHeight) * ratio;
+		if (cache->key == key && cache->image.size() == size) {
+			p.drawImage(0, 0, cache->image);
+			return;
+		}
+		cache->key = std::move(key);
+		if (cache->image.size() != size) {
+			cache->image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+			cache->image.setDevicePixelRatio(ratio);
+		}
+	}
+	auto q = std::optional<Painter>();
+	if (cache) {
+		q.emplace(&cache->image);
+	}
+	auto &to = q ? *q : p;
 	const auto paintItemCallback = [&](int nameleft, int namewidth) {
 		const auto texttop = st::dialogsPadding.y()
 			+ st::msgNameFont->height
 			+ st::dialogsSkip;
 		const auto availableWidth = PaintWideCounter(
-			p,
+			to,
 			texttop,
 			namewidth,
 			fullWidth,
@@ -765,7 +908,7 @@ void RowPainter::paint(
 			st::dialogsTextFont->height);
 		const auto actionWasPainted = ShowSendActionInDialogs(history)
 			? history->sendActionPainter()->paint(
-				p,
+				to,
 				itemRect.x(),
 				itemRect.y(),
 				itemRect.width(),
@@ -774,10 +917,10 @@ void RowPainter::paint(
 				ms)
 			: false;
 		if (const auto folder = row->folder()) {
-			PaintListEntryText(p, itemRect, active, selected, row);
+			PaintListEntryText(to, itemRect, active, selected, row);
 		} else if (!actionWasPainted) {
 			item->drawInDialog(
-				p,
+				to,
 				itemRect,
 				active,
 				selected,
@@ -788,7 +931,7 @@ void RowPainter::paint(
 	};
 	const auto paintCounterCallback = [&] {
 		PaintNarrowCounter(
-			p,
+			to,
 			displayUnreadCounter,
 			displayUnreadMark,
 			displayMentionBadge,
@@ -798,7 +941,7 @@ void RowPainter::paint(
 			mentionMuted);
 	};
 	paintRow(
-		p,
+		to,
 		row,
 		entry,
 		row->key(),
@@ -813,6 +956,18 @@ void RowPainter::paint(
 		ms,
 		paintItemCallback,
 		paintCounterCallback);
+	if (q) {
+		q.reset();
+		p.drawImage(0, 0, cache->image);
+	}
+}
+
+void InvalidateRowCache(not_null<const Row*> row) {
+	RowsCache.remove(row);
+}
+
+void ClearRowsCache() {
+	RowsCache.clear();
 }
 
 void RowPainter::paint(
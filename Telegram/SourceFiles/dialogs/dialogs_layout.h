@@ -46,6 +46,10 @@ public:
 
 };
 
+// Rendered rows are reused while nothing shown in them changes.
+void InvalidateRowCache(not_null<const Row*> row);
+void ClearRowsCache();
+
 void PaintCollapsedRow(
 	Painter &p,
 	const BasicRow &row,
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_changes.h"
 #include "main/main_session.h"
 #include "history/history.h"
+#include "core/application.h"
 
 namespace Dialogs {
 
@@ -193,6 +194,21 @@ rpl::producer<UnreadState> MainList::unreadStateChanges() const {
 	return _unreadStateChanges.events();
 }
 
+rpl::producer<> MainList::unreadStateUpdates() const {
+	return _unreadStateUpdates.events();
+}
+
+void MainList::scheduleUnreadStateUpdate() {
+	if (_unreadStateUpdateScheduled) {
+		return;
+	}
+	_unreadStateUpdateScheduled = true;
+	Core::App().postponeCall(crl::guard(this, [=] {
+		_unreadStateUpdateScheduled = false;
+		_unreadStateUpdates.fire({});
+	}));
+}
+
 not_null<IndexedList*> MainList::indexed() {
 	return &_all;
 }
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "dialogs/dialogs_indexed_list.h"
 #include "dialogs/dialogs_pinned_list.h"
+#include "base/weak_ptr.h"
 
 namespace Main {
 class Session;
@@ -16,7 +17,7 @@ class Session;
 
 namespace Dialogs {
 
-class MainList final {
+class MainList final : public base::has_weak_ptr {
 public:
 	MainList(
 		not_null<Main::Session*> session,
@@ -43,6 +44,9 @@ public:
 	[[nodiscard]] UnreadState unreadState() const;
 	[[nodiscard]] rpl::producer<UnreadState> unreadStateChanges() const;
 
+	// Fires once after a burst of unread state changes is processed.
+	[[nodiscard]] rpl::producer<> unreadStateUpdates() const;
+
 	[[nodiscard]] not_null<IndexedList*> indexed();
 	[[nodiscard]] not_null<const IndexedList*> indexed() const;
 	[[nodiscard]] not_null<PinnedList*> pinned();
@@ -54,12 +58,14 @@ public:
 private:
 	void finalizeCloudUnread();
 	void recomputeFullListSize();
+	void scheduleUnreadStateUpdate();
 
 	auto unreadStateChangeNotifier(bool notify) {
 		const auto wasState = notify ? unreadState() : UnreadState();
 		return gsl::finally([=] {
 			if (notify) {
 				_unreadStateChanges.fire_copy(wasState);
+				scheduleUnreadStateUpdate();
 			}
 		});
 	}
@@ -70,6 +76,8 @@ private:
 	UnreadState _unreadState;
 	UnreadState _cloudUnreadState;
 	rpl::event_stream<UnreadState> _unreadStateChanges;
+	rpl::event_stream<> _unreadStateUpdates;
+	bool _unreadStateUpdateScheduled = false;
 	rpl::variable<int> _fullListSize = 0;
 	int _cloudListSize = 0;
 
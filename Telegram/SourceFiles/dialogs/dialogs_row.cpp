@@ -131,6 +131,12 @@ void BasicRow::paintRipple(
 	}
 }
 
+bool BasicRow::animating() const {
+	return _ripple
+		|| (_cornerBadgeUserpic
+			&& _cornerBadgeUserpic->animation.animating());
+}
+
 void BasicRow::updateCornerBadgeShown(
 		not_null<PeerData*> peer,
 		Fn<void()> updateCallback) const {
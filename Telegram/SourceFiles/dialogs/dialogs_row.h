@@ -59,6 +59,11 @@ public:
 		return _userpic;
 	}
 
+	[[nodiscard]] bool cornerBadgeShown() const {
+		return _cornerBadgeShown;
+	}
+	[[nodiscard]] bool animating() const;
+
 private:
 	struct CornerBadgeUserpic {
 		InMemoryKey key;
@@ -41,6 +41,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "data/data_channel.h"
 #include "data/data_chat.h"
+#include "data/data_messages_search_index.h"
 #include "data/data_user.h"
 #include "data/data_folder.h"
 #include "data/data_histories.h"
@@ -821,6 +822,7 @@ bool Widget::onSearchMessages(bool searchCache) {
 			_searchNextRate = 0;
 			_searchFull = _searchFullMigrated = false;
 			cancelSearchRequest();
+			searchLocalMessages();
 			searchReceived(
 				_searchInChat
 					? SearchRequestType::PeerFromStart
@@ -835,6 +837,7 @@ bool Widget::onSearchMessages(bool searchCache) {
 		_searchNextRate = 0;
 		_searchFull = _searchFullMigrated = false;
 		cancelSearchRequest();
+		searchLocalMessages();
 		if (const auto peer = _searchInChat.peer()) {
 			auto &histories = session().data().histories();
 			const auto type = Data::Histories::RequestType::History;
@@ -935,6 +938,20 @@ bool Widget::onSearchMessages(bool searchCache) {
 	return result;
 }
 
+void Widget::searchLocalMessages() {
+	// Show the messages we already have while waiting for the server.
+	const auto history = _searchInChat.history();
+	if (_searchQuery.isEmpty() || (_searchInChat && !history)) {
+		return;
+	}
+	_inner->localSearchReceived(
+		session().data().messagesSearchIndex().search(
+			_searchQuery,
+			history,
+			_searchQueryFrom,
+			SearchPerPage));
+}
+
 bool Widget::searchForPeersRequired(const QString &query) const {
 	if (_searchInChat || query.isEmpty()) {
 		return false;
@@ -142,6 +142,7 @@ private:
 		mtpRequestId requestId);
 	void escape();
 	void cancelSearchRequest();
+	void searchLocalMessages();
 
 	void setupSupportMode();
 	void setupConnectingWidget();
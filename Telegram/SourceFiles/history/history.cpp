@@ -1221,6 +1221,18 @@ void History::addOlderSlice(const QVector<MTPMessage> &slice) {
 	checkLastMessage();
 }
 
+void History::addCachedSlice(const QVector<MTPMessage> &slice) {
+	Expects(isEmpty());
+
+	if (const auto added = createItems(slice); !added.empty()) {
+		startBuildingFrontBlock(added.size());
+		for (const auto item : added) {
+			addItemToBlock(item);
+		}
+		finishBuildingFrontBlock();
+	}
+}
+
 void History::addNewerSlice(const QVector<MTPMessage> &slice) {
 	bool wasLoadedAtBottom = loadedAtBottom();
 
@@ -3007,6 +3019,7 @@ void History::clear(ClearType type) {
 		}
 		_notifications.clear();
 		owner().notifyHistoryCleared(this);
+		session().local().removeCachedMessages(peer->id);
 		if (unreadCountKnown()) {
 			setUnreadCount(0);
 		}
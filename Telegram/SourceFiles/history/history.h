@@ -178,6 +178,10 @@ public:
 	void addOlderSlice(const QVector<MTPMessage> &slice);
 	void addNewerSlice(const QVector<MTPMessage> &slice);
 
+	// Messages from the local cache are shown until the server answers,
+	// they're not added to shared media or any other lists.
+	void addCachedSlice(const QVector<MTPMessage> &slice);
+
 	void newItemAdded(not_null<HistoryItem*> item);
 
 	void registerLocalMessage(not_null<HistoryItem*> item);
@@ -45,6 +45,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_channel.h"
 #include "data/data_user.h"
 #include "data/data_histories.h"
+#include "data/data_messages_search_index.h"
 #include "app.h"
 #include "styles/style_dialogs.h"
 #include "styles/style_widgets.h"
@@ -1543,6 +1544,10 @@ TextWithEntities HistoryMessage::withLocalEntities(
 }
 
 void HistoryMessage::setText(const TextWithEntities &textWithEntities) {
+	history()->owner().messagesSearchIndex().update(
+		this,
+		textWithEntities.text);
+
 	for (const auto &entity : textWithEntities.entities) {
 		auto type = entity.type();
 		if (type == EntityType::Url
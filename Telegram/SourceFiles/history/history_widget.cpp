@@ -2092,6 +2092,11 @@ void HistoryWidget::clearAllLoadRequests() {
 		histories.cancelRequest(_firstLoadRequest);
 		_firstLoadRequest = 0;
 	}
+	if (base::take(_showingCachedMessages)) {
+		// The cached slice was never replaced by the server answer,
+		// it could have stale or already deleted messages.
+		_history->clear(History::ClearType::Unload);
+	}
 	if (_preloadRequest) {
 		histories.cancelRequest(_preloadRequest);
 		_preloadRequest = 0;
@@ -2588,11 +2593,15 @@ void HistoryWidget::messagesReceived(PeerData *peer, const MTPmessages_Messages
 			checkHistoryActivation();
 		}
 	} else if (_firstLoadRequest == requestId) {
-		if (toMigrated) {
+		if (toMigrated || base::take(_showingCachedMessages)) {
 			_history->clear(History::ClearType::Unload);
 		} else if (_migrated) {
 			_migrated->clear(History::ClearType::Unload);
 		}
+		if (_firstLoadFromBottom
+			&& messages.type() != mtpc_messages_messagesNotModified) {
+			session().local().writeCachedMessages(peer->id, messages);
+		}
 		addMessagesToFront(peer, *histList);
 		_firstLoadRequest = 0;
 		if (_history->loadedAtTop() && _history->isEmpty() && count > 0) {
@@ -2709,6 +2718,11 @@ void HistoryWidget::firstLoadMessages() {
 		}
 	}
 
+	_firstLoadFromBottom = (from == _history) && !offsetId && !offset;
+	if (_firstLoadFromBottom && !_migrated && _history->isEmpty()) {
+		showCachedMessages();
+	}
+
 	auto offsetDate = 0;
 	auto maxId = 0;
 	auto minId = 0;
@@ -2737,8 +2751,36 @@ void HistoryWidget::firstLoadMessages() {
 	});
 }
 
+void HistoryWidget::showCachedMessages() {
+	const auto peer = _history->peer;
+	const auto cached = session().local().readCachedMessages(peer->id);
+	if (!cached) {
+		return;
+	}
+	const auto owner = &_history->owner();
+	const auto list = cached->match([&](
+			const MTPDmessages_messagesNotModified &) {
+		return QVector<MTPMessage>();
+	}, [&](const auto &data) {
+		owner->processCachedUsers(data.vusers());
+		owner->processCachedChats(data.vchats());
+		return data.vmessages().v;
+	});
+	if (list.isEmpty()) {
+		return;
+	}
+
+	// Show what we had the last time until the server answers,
+	// the cached slice is replaced in messagesReceived().
+	_history->addCachedSlice(list);
+	if (!_history->isEmpty()) {
+		_showingCachedMessages = true;
+		historyLoaded();
+	}
+}
+
 void HistoryWidget::loadMessages() {
-	if (!_history || _preloadRequest) {
+	if (!_history || _preloadRequest || _showingCachedMessages) {
 		return;
 	}
 
@@ -2789,7 +2831,7 @@ void HistoryWidget::loadMessages() {
 }
 
 void HistoryWidget::loadMessagesDown() {
-	if (!_history || _preloadDownRequest) {
+	if (!_history || _preloadDownRequest || _showingCachedMessages) {
 		return;
 	}
 
@@ -147,6 +147,7 @@ public:
 	void loadMessages();
 	void loadMessagesDown();
 	void firstLoadMessages();
+	void showCachedMessages();
 	void delayedShowAt(MsgId showAtMsgId);
 
 	QRect historyRect() const;
@@ -651,6 +652,8 @@ private:
 	int _firstLoadRequest = 0; // Not real mtpRequestId.
 	int _preloadRequest = 0; // Not real mtpRequestId.
 	int _preloadDownRequest = 0; // Not real mtpRequestId.
+	bool _firstLoadFromBottom = false;
+	bool _showingCachedMessages = false;
 
 	MsgId _delayedShowAtMsgId = -1;
 	int _delayedShowAtRequest = 0; // Not real mtpRequestId.
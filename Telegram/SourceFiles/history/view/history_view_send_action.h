@@ -43,6 +43,10 @@ public:
 		style::color color,
 		crl::time now);
 
+	[[nodiscard]] bool animating() const {
+		return bool(_sendActionAnimation);
+	}
+
 	bool updateNeedsAnimating(
 		crl::time now,
 		bool force = false);
@@ -54,6 +54,12 @@ constexpr auto kPreloadedScreensCountFull
 	= kPreloadedScreensCount + 1 + kPreloadedScreensCount;
 constexpr auto kMediaCountForSearch = 10;
 
+// Items that will be shown in this time at the current scroll speed
+// are prefetched, up to a few screens ahead of the scroll direction.
+constexpr auto kPrefetchAheadTime = crl::time(700);
+constexpr auto kPrefetchMaxScreens = 4;
+constexpr auto kScrollSpeedTimeout = crl::time(200);
+
 UniversalMsgId GetUniversalId(FullMsgId itemId) {
 	return (itemId.channel != 0)
 		? UniversalMsgId(itemId.msg)
@@ -140,6 +146,10 @@ public:
 		const Context &context,
 		QRect clip,
 		int outerWidth) const;
+	void collectItems(
+		int top,
+		int bottom,
+		std::vector<not_null<BaseLayout*>> &to) const;
 
 	void paintFloatingHeader(Painter &p, int visibleTop, int outerWidth);
 
@@ -434,6 +444,17 @@ void ListWidget::Section::paint(
 	}
 }
 
+void ListWidget::Section::collectItems(
+		int top,
+		int bottom,
+		std::vector<not_null<BaseLayout*>> &to) const {
+	const auto fromIt = findItemAfterTop(top);
+	const auto tillIt = findItemAfterBottom(fromIt, bottom);
+	for (auto it = fromIt; it != tillIt; ++it) {
+		to.push_back(it->second);
+	}
+}
+
 void ListWidget::Section::paintFloatingHeader(
 		Painter &p,
 		int visibleTop,
@@ -1117,11 +1138,13 @@ auto ListWidget::foundItemInSection(
 void ListWidget::visibleTopBottomUpdated(
 		int visibleTop,
 		int visibleBottom) {
+	updateScrollSpeed(visibleTop);
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 
 	checkMoveToOtherViewer();
 	clearHeavyItems();
+	prefetchAhead();
 
 	if (_dateBadge.goodType) {
 		updateDateBadgeFor(_visibleTop);
@@ -1137,6 +1160,51 @@ void ListWidget::visibleTopBottomUpdated(
 	}
 }
 
+void ListWidget::updateScrollSpeed(int visibleTop) {
+	const auto now = crl::now();
+	const auto elapsed = now - _scrollSpeedUpdated;
+	const auto delta = visibleTop - _visibleTop;
+	_scrollSpeedUpdated = now;
+	if (elapsed <= 0 || elapsed > kScrollSpeedTimeout) {
+		_scrollSpeed = 0.;
+	} else {
+		// Smooth the speed a little, wheel scroll comes in jumps.
+		_scrollSpeed = (_scrollSpeed + delta / float64(elapsed)) / 2.;
+	}
+}
+
+int ListWidget::prefetchDistance() const {
+	const auto visibleHeight = _visibleBottom - _visibleTop;
+	const auto ahead = std::abs(_scrollSpeed) * kPrefetchAheadTime;
+	return std::min(int(ahead), kPrefetchMaxScreens * visibleHeight);
+}
+
+void ListWidget::prefetchAhead() {
+	const auto distance = prefetchDistance();
+	if (!distance || _sections.empty()) {
+		return;
+	}
+	const auto down = (_scrollSpeed > 0.);
+	const auto top = down ? _visibleBottom : (_visibleTop - distance);
+	const auto bottom = down ? (_visibleBottom + distance) : _visibleTop;
+
+	auto items = std::vector<not_null<BaseLayout*>>();
+	const auto fromSectionIt = findSectionAfterTop(top);
+	const auto tillSectionIt = findSectionAfterBottom(fromSectionIt, bottom);
+	for (auto it = fromSectionIt; it != tillSectionIt; ++it) {
+		it->collectItems(top - it->top(), bottom - it->top(), items);
+	}
+
+	// Newer download requests are served first,
+	// so request the nearest items last.
+	if (down) {
+		ranges::reverse(items);
+	}
+	for (const auto item : items) {
+		item->preload();
+	}
+}
+
 void ListWidget::updateDateBadgeFor(int top) {
 	if (_sections.empty()) {
 		return;
@@ -1185,14 +1253,17 @@ void ListWidget::checkMoveToOtherViewer() {
 	auto topItem = findItemByPoint({ 0, _visibleTop });
 	auto bottomItem = findItemByPoint({ 0, _visibleBottom });
 
-	auto preloadedHeight = kPreloadedScreensCountFull * visibleHeight;
+	// When scrolling fast the ids are requested further in advance.
+	const auto ahead = prefetchDistance();
+	auto preloadedHeight = kPreloadedScreensCountFull * visibleHeight
+		+ 2 * ahead;
 	auto minItemHeight = Section::MinItemHeight(_type, width());
 	auto preloadedCount = preloadedHeight / minItemHeight;
 	auto preloadIdsLimitMin = (preloadedCount / 2) + 1;
 	auto preloadIdsLimit = preloadIdsLimitMin
 		+ (visibleHeight / minItemHeight);
 
-	auto preloadBefore = kPreloadIfLessThanScreens * visibleHeight;
+	auto preloadBefore = kPreloadIfLessThanScreens * visibleHeight + ahead;
 	auto after = _slice.skippedAfter();
 	auto preloadTop = (_visibleTop < preloadBefore);
 	auto topLoaded = after && (*after == 0);
@@ -1237,8 +1308,11 @@ void ListWidget::clearHeavyItems() {
 		return;
 	}
 	_heavyLayoutsInvalidated = false;
-	const auto above = _visibleTop - visibleHeight;
-	const auto below = _visibleBottom + visibleHeight;
+	const auto ahead = std::max(prefetchDistance(), visibleHeight);
+	const auto above = _visibleTop
+		- ((_scrollSpeed < 0.) ? ahead : visibleHeight);
+	const auto below = _visibleBottom
+		+ ((_scrollSpeed > 0.) ? ahead : visibleHeight);
 	for (auto i = _heavyLayouts.begin(); i != _heavyLayouts.end();) {
 		const auto item = const_cast<BaseLayout*>(i->get());
 		const auto rect = findItemDetails(item).geometry;
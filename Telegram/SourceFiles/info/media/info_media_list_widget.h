@@ -285,6 +285,9 @@ private:
 	void switchToWordSelection();
 	void validateTrippleClickStartTime();
 	void checkMoveToOtherViewer();
+	void updateScrollSpeed(int visibleTop);
+	[[nodiscard]] int prefetchDistance() const;
+	void prefetchAhead();
 	void clearHeavyItems();
 
 	void setActionBoxWeak(QPointer<Ui::RpWidget> box);
@@ -307,6 +310,8 @@ private:
 
 	int _visibleTop = 0;
 	int _visibleBottom = 0;
+	float64 _scrollSpeed = 0.; // Pixels per millisecond, down is positive.
+	crl::time _scrollSpeedUpdated = 0;
 	ScrollTopState _scrollTopState;
 	rpl::event_stream<int> _scrollToRequests;
 
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "core/shortcuts.h"
 #include "core/crash_reports.h"
+#include "core/core_startup_trace.h"
 #include "main/main_account.h"
 #include "main/main_session.h"
 #include "data/data_session.h"
@@ -124,6 +125,9 @@ void Domain::resetWithForgottenPasscode() {
 void Domain::activateAfterStarting() {
 	Expects(started());
 
+	const auto trace = Core::StartupTraceScope(
+		"Main::Domain::activateAfterStarting");
+
 	auto toActivate = _accounts.front().account.get();
 	for (const auto &[index, account] : _accounts) {
 		if (index == _accountToActivate) {
@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_domain.h"
 #include "main/main_session_settings.h"
 #include "mtproto/mtproto_config.h"
+#include "core/core_startup_trace.h"
 #include "chat_helpers/stickers_emoji_pack.h"
 #include "chat_helpers/stickers_dice_pack.h"
 #include "storage/file_download.h"
@@ -130,6 +131,9 @@ Session::Session(
 
 		// Storage::Account uses Main::Account::session() in those methods.
 		// So they can't be called during Main::Session construction.
+		const auto trace = Core::StartupTraceScope(
+			"Storage::Account stickers");
+		const auto started = crl::now();
 		local().readInstalledStickers();
 		local().readInstalledMasks();
 		local().readFeaturedStickers();
@@ -137,6 +141,7 @@ Session::Session(
 		local().readRecentMasks();
 		local().readFavedStickers();
 		local().readSavedGifs();
+		LOG(("Stickers read time: %1").arg(crl::now() - started));
 		data().stickers().notifyUpdated();
 		data().stickers().notifySavedGifsUpdated();
 	});
@@ -10,6 +10,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_common.h"
 #include "media/streaming/media_streaming_loader.h"
 #include "storage/cache/storage_cache_database.h"
+#include "storage/storage_cache_budget.h"
+#include "data/data_types.h"
 
 namespace Media {
 namespace Streaming {
@@ -847,9 +849,10 @@ Reader::SerializedSlice Reader::Slices::unloadToCache() {
 
 Reader::Reader(
 	std::unique_ptr<Loader> loader,
-	Storage::Cache::Database *cache)
+	Storage::CacheBudget *cache)
 : _loader(std::move(loader))
-, _cache(cache)
+, _budget(cache)
+, _cache(cache ? &cache->database() : nullptr)
 , _cacheHelper(cache ? InitCacheHelper(_loader->baseCacheKey()) : nullptr)
 , _slices(_loader->size(), _cacheHelper != nullptr) {
 	_loader->parts(
@@ -1146,6 +1149,11 @@ void Reader::readFromCache(int sliceNumber) {
 				bytes::make_span(result),
 				sliceNumber,
 				size);
+			if (!result.isEmpty()) {
+				crl::on_main(weak, [=] {
+					_budget->used(key);
+				});
+			}
 			if (const auto strong = cache.lock()) {
 				QMutexLocker lock(&strong->mutex);
 				strong->results.emplace(sliceNumber, std::move(entry.parts));
@@ -1188,7 +1196,11 @@ void Reader::putToCache(SerializedSlice &&slice) {
 	Expects(_cacheHelper != nullptr);
 	Expects(slice.number >= 0);
 
-	_cache->put(_cacheHelper->key(slice.number), std::move(slice.data));
+	_budget->put(
+		_cacheHelper->key(slice.number),
+		Storage::Cache::Database::TaggedValue(
+			std::move(slice.data),
+			Data::kStreamingCacheTag));
 }
 
 int Reader::size() const {
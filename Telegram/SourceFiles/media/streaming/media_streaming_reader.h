@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Storage {
 class StreamedFileDownloader;
+class CacheBudget;
 } // namespace Storage
 
 namespace Storage {
@@ -42,7 +43,7 @@ public:
 	// Main thread.
 	explicit Reader(
 		std::unique_ptr<Loader> loader,
-		Storage::Cache::Database *cache = nullptr);
+		Storage::CacheBudget *cache = nullptr);
 
 	void setLoaderPriority(int priority);
 
@@ -235,6 +236,7 @@ private:
 		Storage::Cache::Key baseKey);
 
 	const std::unique_ptr<Loader> _loader;
+	Storage::CacheBudget * const _budget = nullptr;
 	Storage::Cache::Database * const _cache = nullptr;
 
 	// shared_ptr is used to be able to have weak_ptr.
@@ -0,0 +1,215 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/details/mtproto_request_slots.h"
+
+namespace MTP::details {
+namespace {
+
+constexpr auto kInitialRingSize = 1024;
+constexpr auto kMaxRingSize = 64 * 1024;
+constexpr auto kMaxDelay = 60;
+
+} // namespace
+
+bool RequestSlots::Slot::empty() const {
+	return !hasDc && !delay && !request && !handler.done && !handler.fail;
+}
+
+RequestSlots::RequestSlots() : _ring(kInitialRingSize) {
+}
+
+void RequestSlots::store(
+		mtpRequestId requestId,
+		const SerializedRequest &request,
+		ResponseHandler &&handler) {
+	QMutexLocker locker(&_mutex);
+	auto &slot = findOrCreate(requestId);
+	slot.request = request;
+	slot.sentAt = crl::now();
+	if (handler.done || handler.fail) {
+		slot.handler = std::move(handler);
+	}
+}
+
+void RequestSlots::unregister(mtpRequestId requestId) {
+	QMutexLocker locker(&_mutex);
+	if (const auto slot = find(requestId)) {
+		slot->request = SerializedRequest();
+		slot->hasDc = false;
+		slot->delay = 0;
+		releaseIfEmpty(*slot);
+	}
+}
+
+SerializedRequest RequestSlots::request(mtpRequestId requestId) const {
+	QMutexLocker locker(&_mutex);
+	const auto slot = find(requestId);
+	return slot ? slot->request : SerializedRequest();
+}
+
+crl::time RequestSlots::sentAt(mtpRequestId requestId) const {
+	QMutexLocker locker(&_mutex);
+	const auto slot = find(requestId);
+	return slot ? slot->sentAt : crl::time(0);
+}
+
+void RequestSlots::resent(mtpRequestId requestId) {
+	QMutexLocker locker(&_mutex);
+	if (const auto slot = find(requestId)) {
+		slot->sentAt = crl::now();
+	}
+}
+
+void RequestSlots::setDc(mtpRequestId requestId, ShiftedDcId shiftedDcId) {
+	QMutexLocker locker(&_mutex);
+	auto &slot = findOrCreate(requestId);
+	slot.shiftedDcId = shiftedDcId;
+	slot.hasDc = true;
+}
+
+std::optional<ShiftedDcId> RequestSlots::dc(mtpRequestId requestId) const {
+	QMutexLocker locker(&_mutex);
+	const auto slot = find(requestId);
+	return (slot && slot->hasDc)
+		? std::make_optional(slot->shiftedDcId)
+		: std::nullopt;
+}
+
+std::optional<ShiftedDcId> RequestSlots::changeDc(
+		mtpRequestId requestId,
+		DcId newdc) {
+	QMutexLocker locker(&_mutex);
+	const auto slot = find(requestId);
+	if (!slot || !slot->hasDc) {
+		return std::nullopt;
+	}
+	slot->shiftedDcId = (slot->shiftedDcId < 0)
+		? -newdc
+		: ShiftDcId(newdc, GetDcIdShift(slot->shiftedDcId));
+	return slot->shiftedDcId;
+}
+
+bool RequestSlots::hasHandler(mtpRequestId requestId) const {
+	QMutexLocker locker(&_mutex);
+	const auto slot = find(requestId);
+	return slot && (slot->handler.done || slot->handler.fail);
+}
+
+ResponseHandler RequestSlots::takeHandler(mtpRequestId requestId) {
+	QMutexLocker locker(&_mutex);
+	const auto slot = find(requestId);
+	if (!slot) {
+		return ResponseHandler();
+	}
+	auto result = base::take(slot->handler);
+	releaseIfEmpty(*slot);
+	return result;
+}
+
+void RequestSlots::setHandler(
+		mtpRequestId requestId,
+		ResponseHandler &&handler) {
+	QMutexLocker locker(&_mutex);
+	findOrCreate(requestId).handler = std::move(handler);
+}
+
+void RequestSlots::clearHandler(mtpRequestId requestId) {
+	QMutexLocker locker(&_mutex);
+	if (const auto slot = find(requestId)) {
+		slot->handler = ResponseHandler();
+		releaseIfEmpty(*slot);
+	}
+}
+
+int RequestSlots::nextDelay(mtpRequestId requestId) {
+	QMutexLocker locker(&_mutex);
+	auto &slot = findOrCreate(requestId);
+	if (!slot.delay) {
+		slot.delay = 1;
+	} else if (slot.delay <= kMaxDelay) {
+		slot.delay *= 2;
+	}
+	return slot.delay;
+}
+
+auto RequestSlots::find(mtpRequestId requestId) -> Slot* {
+	auto &slot = _ring[requestId & (_ring.size() - 1)];
+	if (slot.requestId == requestId) {
+		return &slot;
+	} else if (_overflow.empty()) {
+		return nullptr;
+	}
+	const auto i = _overflow.find(requestId);
+	return (i != end(_overflow)) ? &i->second : nullptr;
+}
+
+auto RequestSlots::find(mtpRequestId requestId) const -> const Slot* {
+	return const_cast<RequestSlots*>(this)->find(requestId);
+}
+
+auto RequestSlots::findOrCreate(mtpRequestId requestId) -> Slot& {
+	Expects(requestId != 0);
+
+	if (const auto existing = find(requestId)) {
+		return *existing;
+	}
+	const auto inRing = _alive - int(_overflow.size());
+	if (inRing * 2 >= int(_ring.size()) && _ring.size() < kMaxRingSize) {
+		grow();
+		return findOrCreate(requestId);
+	}
+	auto &slot = _ring[requestId & (_ring.size() - 1)];
+	if (slot.requestId) {
+		// Some long-living request was overtaken by the ring.
+		const auto overtaken = slot.requestId;
+		_overflow.emplace(overtaken, base::take(slot));
+	}
+	slot.requestId = requestId;
+	++_alive;
+	return slot;
+}
+
+void RequestSlots::releaseIfEmpty(Slot &slot) {
+	if (!slot.empty()) {
+		return;
+	}
+	--_alive;
+	const auto inRing = (&slot >= _ring.data())
+		&& (&slot < _ring.data() + _ring.size());
+	if (inRing) {
+		slot.requestId = 0;
+	} else {
+		const auto requestId = slot.requestId;
+		_overflow.remove(requestId);
+	}
+}
+
+void RequestSlots::grow() {
+	auto was = std::exchange(_ring, std::vector<Slot>(_ring.size() * 2));
+	auto overflow = base::take(_overflow);
+	const auto mask = _ring.size() - 1;
+	const auto put = [&](Slot &&slot) {
+		auto &to = _ring[slot.requestId & mask];
+		if (to.requestId) {
+			const auto requestId = slot.requestId;
+			_overflow.emplace(requestId, std::move(slot));
+		} else {
+			to = std::move(slot);
+		}
+	};
+	for (auto &slot : was) {
+		if (slot.requestId) {
+			put(std::move(slot));
+		}
+	}
+	for (auto &[requestId, slot] : overflow) {
+		put(std::move(slot));
+	}
+}
+
+} // namespace MTP::details
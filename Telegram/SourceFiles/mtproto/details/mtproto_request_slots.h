@@ -0,0 +1,81 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "mtproto/details/mtproto_serialized_request.h"
+#include "mtproto/mtproto_response.h"
+#include "base/flat_map.h"
+
+#include <QtCore/QMutex>
+
+namespace MTP::details {
+
+// All per-request bookkeeping of MTP::Instance in one place.
+//
+// Request ids are monotonic, so most of the alive requests fit in a ring
+// indexed by (requestId & mask) without any collisions. A request that
+// lives long enough to be overtaken by the ring is moved to a small
+// overflow map, so the ring never has to grow because of it.
+class RequestSlots final {
+public:
+	RequestSlots();
+
+	void store(
+		mtpRequestId requestId,
+		const SerializedRequest &request,
+		ResponseHandler &&handler);
+	void unregister(mtpRequestId requestId);
+
+	[[nodiscard]] SerializedRequest request(mtpRequestId requestId) const;
+	[[nodiscard]] crl::time sentAt(mtpRequestId requestId) const;
+
+	// Latency is counted from the last send, not the waiting before it.
+	void resent(mtpRequestId requestId);
+
+	void setDc(mtpRequestId requestId, ShiftedDcId shiftedDcId);
+	[[nodiscard]] std::optional<ShiftedDcId> dc(
+		mtpRequestId requestId) const;
+	std::optional<ShiftedDcId> changeDc(
+		mtpRequestId requestId,
+		DcId newdc);
+
+	[[nodiscard]] bool hasHandler(mtpRequestId requestId) const;
+	[[nodiscard]] ResponseHandler takeHandler(mtpRequestId requestId);
+	void setHandler(mtpRequestId requestId, ResponseHandler &&handler);
+	void clearHandler(mtpRequestId requestId);
+
+	// Exponential back-off for temporary server errors, in seconds.
+	[[nodiscard]] int nextDelay(mtpRequestId requestId);
+
+private:
+	struct Slot {
+		mtpRequestId requestId = 0;
+		ShiftedDcId shiftedDcId = 0;
+		bool hasDc = false;
+		int delay = 0;
+		crl::time sentAt = 0;
+		SerializedRequest request;
+		ResponseHandler handler;
+
+		[[nodiscard]] bool empty() const;
+	};
+
+	[[nodiscard]] Slot *find(mtpRequestId requestId);
+	[[nodiscard]] const Slot *find(mtpRequestId requestId) const;
+	[[nodiscard]] Slot &findOrCreate(mtpRequestId requestId);
+	void releaseIfEmpty(Slot &slot);
+	void grow();
+
+	mutable QMutex _mutex;
+	std::vector<Slot> _ring;
+	base::flat_map<mtpRequestId, Slot> _overflow;
+	int _alive = 0;
+
+};
+
+} // namespace MTP::details
@@ -0,0 +1,80 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/details/mtproto_request_stats.h"
+
+namespace MTP::details {
+
+void RequestStats::add(crl::time latency, int64 bytes) {
+	if (!_count) {
+		_started = crl::now() - latency;
+	}
+	++_buckets[BucketIndex(latency)];
+	++_count;
+	_bytes += bytes;
+	accumulate_max(_max, latency);
+}
+
+int RequestStats::count() const {
+	return _count;
+}
+
+RequestStatsSnapshot RequestStats::snapshot() const {
+	return {
+		.count = _count,
+		.bytes = _bytes,
+		.duration = _count ? (crl::now() - _started) : 0,
+		.p50 = percentile(50),
+		.p90 = percentile(90),
+		.p99 = percentile(99),
+		.max = _max,
+	};
+}
+
+void RequestStats::clear() {
+	*this = RequestStats();
+}
+
+int RequestStats::BucketIndex(crl::time latency) {
+	if (latency < kSubBuckets) {
+		return std::max(int(latency), 0);
+	}
+	auto power = 0;
+	while ((latency >> (power + 1)) >= kSubBuckets) {
+		++power;
+	}
+	const auto sub = int(latency >> power) - kSubBuckets;
+	return std::min(
+		(power + 1) * kSubBuckets + sub,
+		kBuckets - 1);
+}
+
+crl::time RequestStats::BucketValue(int index) {
+	if (index < kSubBuckets) {
+		return index;
+	}
+	const auto power = index / kSubBuckets - 1;
+	const auto sub = index % kSubBuckets;
+	return crl::time(kSubBuckets + sub) << power;
+}
+
+crl::time RequestStats::percentile(int percent) const {
+	if (!_count) {
+		return 0;
+	}
+	const auto wanted = (int64(_count) * percent + 99) / 100;
+	auto counted = int64(0);
+	for (auto i = 0; i != kBuckets; ++i) {
+		counted += _buckets[i];
+		if (counted >= wanted) {
+			return std::min(BucketValue(i), _max);
+		}
+	}
+	return _max;
+}
+
+} // namespace MTP::details
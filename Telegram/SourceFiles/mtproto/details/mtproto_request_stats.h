@@ -0,0 +1,49 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <crl/crl_time.h>
+
+namespace MTP::details {
+
+struct RequestStatsSnapshot {
+	int count = 0;
+	int64 bytes = 0;
+	crl::time duration = 0;
+	crl::time p50 = 0;
+	crl::time p90 = 0;
+	crl::time p99 = 0;
+	crl::time max = 0;
+};
+
+// Round-trip latency histogram with logarithmic buckets,
+// four buckets for each power of two milliseconds.
+class RequestStats final {
+public:
+	void add(crl::time latency, int64 bytes);
+	[[nodiscard]] int count() const;
+	[[nodiscard]] RequestStatsSnapshot snapshot() const;
+	void clear();
+
+private:
+	static constexpr auto kSubBuckets = 4;
+	static constexpr auto kBuckets = 18 * kSubBuckets;
+
+	[[nodiscard]] static int BucketIndex(crl::time latency);
+	[[nodiscard]] static crl::time BucketValue(int index);
+	[[nodiscard]] crl::time percentile(int percent) const;
+
+	std::array<int, kBuckets> _buckets = { { 0 } };
+	int _count = 0;
+	int64 _bytes = 0;
+	crl::time _max = 0;
+	crl::time _started = 0;
+
+};
+
+} // namespace MTP::details
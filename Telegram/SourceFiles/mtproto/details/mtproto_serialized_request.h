@@ -17,6 +17,13 @@ namespace details {
 class RequestData;
 class SerializedRequest;
 
+enum class RequestPriority : uchar {
+	Interactive,
+	Background,
+	Bulk,
+};
+inline constexpr auto kRequestPriorityCount = 3;
+
 class RequestConstructHider {
 	struct Tag {};
 	friend class RequestData;
@@ -90,6 +97,7 @@ public:
 	SerializedRequest after;
 	crl::time lastSentTime = 0;
 	mtpRequestId requestId = 0;
+	RequestPriority priority = RequestPriority::Interactive;
 	bool needsLayer = false;
 	bool forceSendInContainer = false;
 
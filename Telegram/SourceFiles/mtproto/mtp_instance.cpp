@@ -8,6 +8,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtp_instance.h"
 
 #include "mtproto/details/mtproto_dcenter.h"
+#include "mtproto/details/mtproto_request_slots.h"
+#include "mtproto/details/mtproto_request_stats.h"
 #include "mtproto/details/mtproto_rsa_public_key.h"
 #include "mtproto/special_config_request.h"
 #include "mtproto/session.h"
@@ -33,6 +35,7 @@ namespace {
 
 constexpr auto kConfigBecomesOldIn = 2 * 60 * crl::time(1000);
 constexpr auto kConfigBecomesOldForBlockedIn = 8 * crl::time(1000);
+constexpr auto kLogRequestStatsEach = 1000;
 
 using namespace details;
 
@@ -133,6 +136,7 @@ public:
 	SerializedRequest getRequest(mtpRequestId requestId);
 	[[nodiscard]] bool hasCallback(mtpRequestId requestId) const;
 	void processCallback(const Response &response);
+	void countResponse(const Response &response);
 	void processUpdate(const Response &message);
 
 	void onStateChange(ShiftedDcId shiftedDcId, int32 state);
@@ -251,24 +255,17 @@ private:
 	rpl::event_stream<> _allKeysDestroyed;
 
 	// holds dcWithShift for request to this dc or -dc for request to main dc
-	std::map<mtpRequestId, ShiftedDcId> _requestsByDc;
-	mutable QMutex _requestByDcLock;
+	// together with the serialized request, its handler and resend delay
+	RequestSlots _requests;
+	std::array<RequestStats, kRequestPriorityCount> _priorityStats;
 
 	// holds target dcWithShift for auth export request
 	std::map<mtpRequestId, ShiftedDcId> _authExportRequests;
 
-	std::map<mtpRequestId, ResponseHandler> _parserMap;
-	mutable QMutex _parserMapLock;
-
-	std::map<mtpRequestId, SerializedRequest> _requestMap;
-	QReadWriteLock _requestMapLock;
-
 	std::deque<std::pair<mtpRequestId, crl::time>> _delayedRequests;
 	base::flat_map<mtpRequestId, mtpRequestId> _dependentRequests;
 	mutable QMutex _dependentRequestsLock;
 
-	std::map<mtpRequestId, int> _requestsDelays;
-
 	std::set<mtpRequestId> _badGuestDcRequests;
 
 	std::map<DcId, std::vector<mtpRequestId>> _authWaiters;
@@ -620,22 +617,15 @@ void Instance::Private::cancel(mtpRequestId requestId) {
 	DEBUG_LOG(("MTP Info: Cancel request %1.").arg(requestId));
 	const auto shiftedDcId = queryRequestByDc(requestId);
 	auto msgId = mtpMsgId(0);
-	{
-		QWriteLocker locker(&_requestMapLock);
-		auto it = _requestMap.find(requestId);
-		if (it != _requestMap.end()) {
-			msgId = *(mtpMsgId*)(it->second->constData() + 4);
-			_requestMap.erase(it);
-		}
+	if (const auto request = _requests.request(requestId)) {
+		msgId = *(mtpMsgId*)(request->constData() + 4);
 	}
 	unregisterRequest(requestId);
 	if (shiftedDcId) {
 		const auto session = getSession(qAbs(*shiftedDcId));
 		session->cancel(requestId, msgId);
 	}
-
-	QMutexLocker locker(&_parserMapLock);
-	_parserMap.erase(requestId);
+	_requests.clearHandler(requestId);
 }
 
 // result < 0 means waiting for such count of ms.
@@ -912,28 +902,13 @@ bool Instance::Private::configLoadFail(const Error &error) {
 
 std::optional<ShiftedDcId> Instance::Private::queryRequestByDc(
 		mtpRequestId requestId) const {
-	QMutexLocker locker(&_requestByDcLock);
-	auto it = _requestsByDc.find(requestId);
-	if (it != _requestsByDc.cend()) {
-		return it->second;
-	}
-	return std::nullopt;
+	return _requests.dc(requestId);
 }
 
 std::optional<ShiftedDcId> Instance::Private::changeRequestByDc(
 		mtpRequestId requestId,
 		DcId newdc) {
-	QMutexLocker locker(&_requestByDcLock);
-	auto it = _requestsByDc.find(requestId);
-	if (it != _requestsByDc.cend()) {
-		if (it->second < 0) {
-			it->second = -newdc;
-		} else {
-			it->second = ShiftDcId(newdc, GetDcIdShift(it->second));
-		}
-		return it->second;
-	}
-	return std::nullopt;
+	return _requests.changeDc(requestId, newdc);
 }
 
 void Instance::Private::checkDelayedRequests() {
@@ -950,17 +925,13 @@ void Instance::Private::checkDelayedRequests() {
 			continue;
 		}
 
-		auto request = SerializedRequest();
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				DEBUG_LOG(("MTP Error: could not find request %1").arg(requestId));
-				continue;
-			}
-			request = it->second;
+		const auto request = _requests.request(requestId);
+		if (!request) {
+			DEBUG_LOG(("MTP Error: could not find request %1").arg(requestId));
+			continue;
 		}
 		const auto session = getSession(qAbs(dcWithShift));
+		_requests.resent(requestId);
 		session->sendPrepared(request);
 	}
 
@@ -992,6 +963,12 @@ void Instance::Private::sendRequest(
 	}
 	request->lastSentTime = crl::now();
 	request->needsLayer = needsLayer;
+	request->priority = (isDownloadDcId(shiftedDcId)
+		|| isUploadDcId(shiftedDcId))
+		? RequestPriority::Bulk
+		: (msCanWait > 0)
+		? RequestPriority::Background
+		: RequestPriority::Interactive;
 
 	session->sendPrepared(request, msCanWait);
 }
@@ -999,23 +976,13 @@ void Instance::Private::sendRequest(
 void Instance::Private::registerRequest(
 		mtpRequestId requestId,
 		ShiftedDcId shiftedDcId) {
-	QMutexLocker locker(&_requestByDcLock);
-	_requestsByDc[requestId] = shiftedDcId;
+	_requests.setDc(requestId, shiftedDcId);
 }
 
 void Instance::Private::unregisterRequest(mtpRequestId requestId) {
 	DEBUG_LOG(("MTP Info: unregistering request %1.").arg(requestId));
 
-	_requestsDelays.erase(requestId);
-
-	{
-		QWriteLocker locker(&_requestMapLock);
-		_requestMap.erase(requestId);
-	}
-	{
-		QMutexLocker locker(&_requestByDcLock);
-		_requestsByDc.erase(requestId);
-	}
+	_requests.unregister(requestId);
 	{
 		auto toRemove = base::flat_set<mtpRequestId>();
 		auto toResend = base::flat_set<mtpRequestId>();
@@ -1042,16 +1009,12 @@ void Instance::Private::unregisterRequest(mtpRequestId requestId) {
 
 		for (const auto resendingId : toResend) {
 			if (const auto shiftedDcId = queryRequestByDc(resendingId)) {
-				SerializedRequest request;
-				{
-					QReadLocker locker(&_requestMapLock);
-					auto it = _requestMap.find(resendingId);
-					if (it == _requestMap.cend()) {
-						LOG(("MTP Error: could not find dependent request %1").arg(resendingId));
-						return;
-					}
-					request = it->second;
+				const auto request = _requests.request(resendingId);
+				if (!request) {
+					LOG(("MTP Error: could not find dependent request %1").arg(resendingId));
+					return;
 				}
+				_requests.resent(resendingId);
 				getSession(qAbs(*shiftedDcId))->sendPrepared(request);
 			}
 		}
@@ -1062,48 +1025,24 @@ void Instance::Private::storeRequest(
 		mtpRequestId requestId,
 		const SerializedRequest &request,
 		ResponseHandler &&callbacks) {
-	if (callbacks.done || callbacks.fail) {
-		QMutexLocker locker(&_parserMapLock);
-		_parserMap.emplace(requestId, std::move(callbacks));
-	}
-	{
-		QWriteLocker locker(&_requestMapLock);
-		_requestMap.emplace(requestId, request);
-	}
+	_requests.store(requestId, request, std::move(callbacks));
 }
 
 SerializedRequest Instance::Private::getRequest(mtpRequestId requestId) {
-	auto result = SerializedRequest();
-	{
-		QReadLocker locker(&_requestMapLock);
-		auto it = _requestMap.find(requestId);
-		if (it != _requestMap.cend()) {
-			result = it->second;
-		}
-	}
-	return result;
+	return _requests.request(requestId);
 }
 
 bool Instance::Private::hasCallback(mtpRequestId requestId) const {
-	QMutexLocker locker(&_parserMapLock);
-	auto it = _parserMap.find(requestId);
-	return (it != _parserMap.cend());
+	return _requests.hasHandler(requestId);
 }
 
 void Instance::Private::processCallback(const Response &response) {
 	const auto requestId = response.requestId;
-	ResponseHandler handler;
-	{
-		QMutexLocker locker(&_parserMapLock);
-		auto it = _parserMap.find(requestId);
-		if (it != _parserMap.cend()) {
-			handler = std::move(it->second);
-			_parserMap.erase(it);
-
-			DEBUG_LOG(("RPC Info: found parser for request %1, trying to parse response...").arg(requestId));
-		}
-	}
+	countResponse(response);
+	auto handler = _requests.takeHandler(requestId);
 	if (handler.done || handler.fail) {
+		DEBUG_LOG(("RPC Info: found parser for request %1, trying to parse response...").arg(requestId));
+
 		const auto handleError = [&](const Error &error) {
 			DEBUG_LOG(("RPC Info: "
 				"error received, code %1, type %2, description: %3").arg(
@@ -1113,8 +1052,7 @@ void Instance::Private::processCallback(const Response &response) {
 			if (rpcErrorOccured(response, handler, error)) {
 				unregisterRequest(requestId);
 			} else {
-				QMutexLocker locker(&_parserMapLock);
-				_parserMap.emplace(requestId, std::move(handler));
+				_requests.setHandler(requestId, std::move(handler));
 			}
 		};
 
@@ -1145,6 +1083,43 @@ void Instance::Private::processCallback(const Response &response) {
 	}
 }
 
+void Instance::Private::countResponse(const Response &response) {
+	const auto requestId = response.requestId;
+	const auto sentAt = _requests.sentAt(requestId);
+	const auto request = _requests.request(requestId);
+	if (!sentAt || !request) {
+		return;
+	}
+	const auto priority = request->priority;
+	auto &stats = _priorityStats[int(priority)];
+	stats.add(
+		crl::now() - sentAt,
+		response.reply.size() * sizeof(mtpPrime));
+	if (stats.count() < kLogRequestStatsEach) {
+		return;
+	}
+	const auto name = [&] {
+		switch (priority) {
+		case RequestPriority::Interactive: return u"interactive"_q;
+		case RequestPriority::Background: return u"background"_q;
+		case RequestPriority::Bulk: return u"bulk"_q;
+		}
+		Unexpected("Priority in Instance::Private::countResponse.");
+	}();
+	const auto snapshot = stats.snapshot();
+	DEBUG_LOG(("MTP Stats: %1, %2 requests in %3 ms, latency "
+		"p50 %4 ms, p90 %5 ms, p99 %6 ms, max %7 ms, received %8 KB"
+		).arg(name
+		).arg(snapshot.count
+		).arg(snapshot.duration
+		).arg(snapshot.p50
+		).arg(snapshot.p90
+		).arg(snapshot.p99
+		).arg(snapshot.max
+		).arg(snapshot.bytes / 1024));
+	stats.clear();
+}
+
 void Instance::Private::processUpdate(const Response &message) {
 	if (_updatesHandler) {
 		_updatesHandler(message);
@@ -1215,10 +1190,9 @@ void Instance::Private::importDone(
 
 	auto &waiters = _authWaiters[newdc];
 	if (waiters.size()) {
-		QReadLocker locker(&_requestMapLock);
 		for (auto waitedRequestId : waiters) {
-			auto it = _requestMap.find(waitedRequestId);
-			if (it == _requestMap.cend()) {
+			const auto request = _requests.request(waitedRequestId);
+			if (!request) {
 				LOG(("MTP Error: could not find request %1 for resending").arg(waitedRequestId));
 				continue;
 			}
@@ -1231,7 +1205,8 @@ void Instance::Private::importDone(
 			}
 			DEBUG_LOG(("MTP Info: resending request %1 to dc %2 after import auth").arg(waitedRequestId).arg(*shiftedDcId));
 			const auto session = getSession(*shiftedDcId);
-			session->sendPrepared(it->second);
+			_requests.resent(waitedRequestId);
+			session->sendPrepared(request);
 		}
 		waiters.clear();
 	}
@@ -1366,32 +1341,23 @@ bool Instance::Private::onErrorDefault(
 			newdcWithShift = ShiftDcId(newdcWithShift, GetDcIdShift(dcWithShift));
 		}
 
-		auto request = SerializedRequest();
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		const auto request = _requests.request(requestId);
+		if (!request) {
+			LOG(("MTP Error: could not find request %1").arg(requestId));
+			return false;
 		}
 		const auto session = getSession(newdcWithShift);
 		registerRequest(
 			requestId,
 			(dcWithShift < 0) ? -newdcWithShift : newdcWithShift);
+		_requests.resent(requestId);
 		session->sendPrepared(request);
 		return true;
 	} else if (type == qstr("MSG_WAIT_TIMEOUT") || type == qstr("MSG_WAIT_FAILED")) {
-		SerializedRequest request;
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find MSG_WAIT_* request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		const auto request = _requests.request(requestId);
+		if (!request) {
+			LOG(("MTP Error: could not find MSG_WAIT_* request %1").arg(requestId));
+			return false;
 		}
 		if (!request->after) {
 			LOG(("MTP Error: MSG_WAIT_* for not dependent request %1").arg(requestId));
@@ -1415,6 +1381,7 @@ bool Instance::Private::onErrorDefault(
 		}
 
 		if (!request->after) {
+			_requests.resent(requestId);
 			getSession(qAbs(dcWithShift))->sendPrepared(request);
 		} else {
 			QMutexLocker locker(&_dependentRequestsLock);
@@ -1430,12 +1397,7 @@ bool Instance::Private::onErrorDefault(
 
 		int32 secs = 1;
 		if (code < 0 || code >= 500) {
-			auto it = _requestsDelays.find(requestId);
-			if (it != _requestsDelays.cend()) {
-				secs = (it->second > 60) ? it->second : (it->second *= 2);
-			} else {
-				_requestsDelays.emplace(requestId, secs);
-			}
+			secs = _requests.nextDelay(requestId);
 		} else if (m1.hasMatch()) {
 			secs = m1.captured(1).toInt();
 //			if (secs >= 60) return false;
@@ -1493,15 +1455,10 @@ bool Instance::Private::onErrorDefault(
 		return true;
 	} else if (type == qstr("CONNECTION_NOT_INITED")
 		|| type == qstr("CONNECTION_LAYER_INVALID")) {
-		SerializedRequest request;
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		const auto request = _requests.request(requestId);
+		if (!request) {
+			LOG(("MTP Error: could not find request %1").arg(requestId));
+			return false;
 		}
 		auto dcWithShift = ShiftedDcId(0);
 		if (const auto shiftedDcId = queryRequestByDc(requestId)) {
@@ -1513,6 +1470,7 @@ bool Instance::Private::onErrorDefault(
 
 		const auto session = getSession(qAbs(dcWithShift));
 		request->needsLayer = true;
+		_requests.resent(requestId);
 		session->sendPrepared(request);
 		return true;
 	} else if (type == qstr("CONNECTION_LANG_CODE_INVALID")) {
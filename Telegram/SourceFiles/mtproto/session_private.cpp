@@ -59,6 +59,10 @@ constexpr auto kSendStateRequestWaiting = crl::time(1000);
 // How much time to wait for some more requests, when sending msg acks.
 constexpr auto kAckSendWaiting = 10 * crl::time(1000);
 
+// Server limits for a single msg_container.
+constexpr auto kMaxContainerMessages = 1020;
+constexpr auto kMaxContainerSize = 256 * 1024; // In ints.
+
 auto SyncTimeRequestDuration = kFastRequestDuration;
 
 using namespace details;
@@ -91,6 +95,66 @@ using namespace details;
 	})();
 }
 
+// Takes requests to be sent in a single container, interactive first,
+// leaving the rest in toSend for the next send round.
+[[nodiscard]] std::vector<SerializedRequest> TakeByPriority(
+		base::flat_map<mtpRequestId, SerializedRequest> &toSend,
+		int reserved) {
+	auto result = std::vector<SerializedRequest>();
+	if (toSend.empty()) {
+		return result;
+	} else if (toSend.size() == 1) {
+		result.push_back(toSend.begin()->second);
+		toSend.clear();
+		return result;
+	}
+	result.reserve(std::min(int(toSend.size()), kMaxContainerMessages));
+	auto taken = base::flat_set<mtpRequestId>();
+	auto size = 0;
+	const auto take = [&](const SerializedRequest &request) {
+		const auto length = int(request.messageSize());
+		const auto full = !result.empty()
+			&& ((int(result.size()) + reserved >= kMaxContainerMessages)
+				|| (size + length > kMaxContainerSize));
+		if (full) {
+			return false;
+		}
+		const auto after = request->after
+			? request->after->requestId
+			: mtpRequestId(0);
+		if (after && toSend.contains(after) && !taken.contains(after)) {
+			// Keep invokeAfter order, send it together with or after that.
+			return true;
+		}
+		size += length;
+		taken.emplace(request->requestId);
+		result.push_back(request);
+		return true;
+	};
+	const auto takeAll = [&](RequestPriority priority) {
+		for (const auto &[requestId, request] : toSend) {
+			if (request->priority == priority && !take(request)) {
+				return false;
+			}
+		}
+		return true;
+	};
+	const auto priorities = {
+		RequestPriority::Interactive,
+		RequestPriority::Background,
+		RequestPriority::Bulk,
+	};
+	for (const auto priority : priorities) {
+		if (!takeAll(priority)) {
+			break;
+		}
+	}
+	for (const auto &requestId : taken) {
+		toSend.remove(requestId);
+	}
+	return result;
+}
+
 void WrapInvokeAfter(
 		SerializedRequest &to,
 		const SerializedRequest &from,
@@ -690,6 +754,7 @@ void SessionPrivate::tryToSend() {
 	}
 
 	bool needAnyResponse = false;
+	bool sendMoreLater = false;
 	SerializedRequest toSendRequest;
 	{
 		QWriteLocker locker1(_sessionData->toSendMutex());
@@ -704,7 +769,16 @@ void SessionPrivate::tryToSend() {
 			locker1.unlock();
 		}
 
-		uint32 toSendCount = toSend.size();
+		const auto reserved = (pingRequest ? 1 : 0)
+			+ (ackRequest ? 1 : 0)
+			+ (resendRequest ? 1 : 0)
+			+ (stateRequest ? 1 : 0)
+			+ (httpWaitRequest ? 1 : 0)
+			+ (bindDcKeyRequest ? 1 : 0);
+		auto sending = TakeByPriority(toSend, reserved);
+		sendMoreLater = !toSend.empty();
+
+		uint32 toSendCount = sending.size();
 		if (pingRequest) ++toSendCount;
 		if (ackRequest) ++toSendCount;
 		if (resendRequest) ++toSendCount;
@@ -728,11 +802,10 @@ void SessionPrivate::tryToSend() {
 			? httpWaitRequest
 			: bindDcKeyRequest
 			? bindDcKeyRequest
-			: toSend.begin()->second;
+			: sending.front();
 		if (toSendCount == 1 && !first->forceSendInContainer) {
 			toSendRequest = first;
 			if (sendAll) {
-				toSend.clear();
 				locker1.unlock();
 			}
 
@@ -801,7 +874,7 @@ void SessionPrivate::tryToSend() {
 			if (stateRequest) containerSize += stateRequest.messageSize();
 			if (httpWaitRequest) containerSize += httpWaitRequest.messageSize();
 			if (bindDcKeyRequest) containerSize += bindDcKeyRequest.messageSize();
-			for (const auto &[requestId, request] : toSend) {
+			for (const auto &request : sending) {
 				containerSize += request.messageSize();
 				if (needsLayer && request->needsLayer) {
 					containerSize += initSizeInInts;
@@ -818,7 +891,7 @@ void SessionPrivate::tryToSend() {
 			// prepare container + each in invoke after
 			toSendRequest = SerializedRequest::Prepare(
 				containerSize,
-				containerSize + 3 * toSend.size());
+				containerSize + 3 * sending.size());
 			toSendRequest->push_back(mtpc_msg_container);
 			toSendRequest->push_back(toSendCount);
 
@@ -852,7 +925,7 @@ void SessionPrivate::tryToSend() {
 				needAnyResponse = true;
 			}
 
-			for (auto &[requestId, request] : toSend) {
+			for (auto &request : sending) {
 				const auto msgId = prepareToSend(
 					request,
 					bigMsgId,
@@ -897,7 +970,6 @@ void SessionPrivate::tryToSend() {
 					memcpy(toSendRequest->data() + from, request->constData() + 4, len * sizeof(mtpPrime));
 				}
 			}
-			toSend.clear();
 
 			if (stateRequest) {
 				const auto msgId = placeToContainer(
@@ -944,6 +1016,9 @@ void SessionPrivate::tryToSend() {
 		}
 	}
 	sendSecureRequest(std::move(toSendRequest), needAnyResponse);
+	if (sendMoreLater) {
+		_sessionData->queueSendAnything();
+	}
 }
 
 void SessionPrivate::retryByTimer() {
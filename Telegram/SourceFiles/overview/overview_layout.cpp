@@ -59,6 +59,23 @@ TextParseOptions _documentNameOptions = {
 	Qt::LayoutDirectionAuto, // dir
 };
 
+[[nodiscard]] QImage PrepareSquarePix(QImage img, int size, bool blurred) {
+	if (blurred) {
+		img = Images::prepareBlur(std::move(img));
+	}
+	if (img.width() == img.height()) {
+		if (img.width() != size) {
+			img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+		}
+	} else if (img.width() > img.height()) {
+		img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	} else {
+		img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	}
+	img.setDevicePixelRatio(cRetinaFactor());
+	return img;
+}
+
 } // namespace
 
 class Checkbox {
@@ -345,21 +362,10 @@ void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const
 }
 
 void Photo::setPixFrom(not_null<Image*> image) {
-	const auto size = _width * cIntRetinaFactor();
-	auto img = image->original();
-	if (!_goodLoaded) {
-		img = Images::prepareBlur(std::move(img));
-	}
-	if (img.width() == img.height()) {
-		if (img.width() != size) {
-			img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		}
-	} else if (img.width() > img.height()) {
-		img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-	} else {
-		img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-	}
-	img.setDevicePixelRatio(cRetinaFactor());
+	auto img = PrepareSquarePix(
+		image->original(),
+		_width * cIntRetinaFactor(),
+		!_goodLoaded);
 
 	// In case we have inline thumbnail we can unload all images and we still
 	// won't get a blank image in the media viewer when the photo is opened.
@@ -387,6 +393,41 @@ void Photo::clearHeavyPart() {
 	_dataMedia = nullptr;
 }
 
+void Photo::preload() {
+	ensureDataMediaCreated();
+	if (_goodLoaded || _pixPreparing || _width <= 0) {
+		return;
+	}
+	const auto image = _dataMedia->image(Data::PhotoSize::Large)
+		? _dataMedia->image(Data::PhotoSize::Large)
+		: _dataMedia->image(Data::PhotoSize::Thumbnail);
+	if (!image) {
+		return;
+	}
+
+	// Scale the good thumbnail before the item is shown,
+	// so that paint() only has to draw the ready pixmap.
+	_pixPreparing = true;
+	const auto size = _width * cIntRetinaFactor();
+	crl::async([=, weak = base::make_weak(this), img = image->original()](
+			) mutable {
+		auto prepared = PrepareSquarePix(std::move(img), size, false);
+		crl::on_main(weak, [=, prepared = std::move(prepared)]() mutable {
+			_pixPreparing = false;
+			if (_goodLoaded || _width * cIntRetinaFactor() != size) {
+				return;
+			}
+			_goodLoaded = true;
+			if (!_data->inlineThumbnailBytes().isEmpty()) {
+				_dataMedia = nullptr;
+				delegate()->unregisterHeavyItem(this);
+			}
+			_pix = Ui::PixmapFromImage(std::move(prepared));
+			parent()->history()->owner().requestItemRepaint(parent());
+		});
+	});
+}
+
 TextState Photo::getState(
 		QPoint point,
 		StateRequest request) const {
@@ -542,6 +583,10 @@ void Video::clearHeavyPart() {
 	_dataMedia = nullptr;
 }
 
+void Video::preload() {
+	ensureDataMediaCreated();
+}
+
 float64 Video::dataProgress() const {
 	ensureDataMediaCreated();
 	return _dataMedia->progress();
@@ -72,6 +72,10 @@ public:
 	virtual void clearHeavyPart() {
 	}
 
+	// Called for items that are about to be scrolled into view.
+	virtual void preload() {
+	}
+
 protected:
 	[[nodiscard]] not_null<HistoryItem*> parent() const {
 		return _parent;
@@ -188,6 +192,7 @@ public:
 		StateRequest request) const override;
 
 	void clearHeavyPart() override;
+	void preload() override;
 
 private:
 	void ensureDataMediaCreated() const;
@@ -199,6 +204,7 @@ private:
 
 	QPixmap _pix;
 	bool _goodLoaded = false;
+	bool _pixPreparing = false;
 
 };
 
@@ -218,6 +224,7 @@ public:
 		StateRequest request) const override;
 
 	void clearHeavyPart() override;
+	void preload() override;
 
 protected:
 	float64 dataProgress() const override;
@@ -10,10 +10,19 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtproto_auth_key.h"
 #include "base/platform/base_platform_file_utilities.h"
 #include "base/openssl_help.h"
+#include "core/core_startup_trace.h"
+#include "base/timer.h"
 
+#include <crl/crl_async.h>
 #include <crl/crl_object_on_thread.h>
 #include <QtCore/QtEndian>
 #include <QtCore/QSaveFile>
+#include <QtCore/QWaitCondition>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif // Q_OS_LINUX
 
 namespace Storage {
 namespace details {
@@ -23,6 +32,8 @@ constexpr char TdfMagic[] = { 'T', 'D', 'F', '$' };
 constexpr auto TdfMagicLen = int(sizeof(TdfMagic));
 
 constexpr auto kStrongIterationsCount = 100'000;
+constexpr auto kWriteDelay = crl::time(500);
+constexpr auto kMaxWriteBatch = 64;
 
 struct WriteEntry {
 	QString basePath;
@@ -37,13 +48,15 @@ public:
 
 	void write(WriteEntry &&entry);
 	void writeSync(WriteEntry &&entry);
+	void writeScheduled();
 	void writeSyncAll();
+	void append(WriteEntry &&entry);
 
 private:
-	void scheduleWrite();
-	void writeScheduled();
-	bool writeOneScheduledNow();
+	[[nodiscard]] std::vector<WriteEntry> takeBatch();
+	void writeBatch(std::vector<WriteEntry> &&entries);
 	void writeNow(WriteEntry &&entry);
+	void syncFiles(const std::vector<std::unique_ptr<QFile>> &files);
 
 	template <typename File>
 	[[nodiscard]] bool open(File &file, const WriteEntry &entry, char postfix);
@@ -62,15 +75,41 @@ class AsyncWriteManager final {
 public:
 	void write(WriteEntry &&entry);
 	void writeSync(WriteEntry &&entry);
+	void append(WriteEntry &&entry);
 	void sync();
 	void stop();
 
 private:
+	void ensureManager();
+	void flush();
+
 	std::optional<crl::object_on_thread<WriteManager>> _manager;
+	std::optional<base::Timer> _flushTimer;
 	bool _finished = false;
 
 };
 
+QMutex StatsMutex;
+WriteStats Stats;
+
+void AddWritten(int files, int64 bytes) {
+	QMutexLocker lock(&StatsMutex);
+	Stats.files += files;
+	Stats.bytes += bytes;
+}
+
+void AddCoalesced() {
+	QMutexLocker lock(&StatsMutex);
+	++Stats.coalesced;
+}
+
+void AddSynced(int batches, int syncs, crl::time duration) {
+	QMutexLocker lock(&StatsMutex);
+	Stats.batches += batches;
+	Stats.syncs += syncs;
+	Stats.syncDuration += duration;
+}
+
 WriteManager::WriteManager(crl::weak_on_thread<WriteManager> weak)
 : _weak(std::move(weak)) {
 }
@@ -81,8 +120,8 @@ void WriteManager::write(WriteEntry &&entry) {
 		_scheduled.push_back(std::move(entry));
 	} else {
 		*i = std::move(entry);
+		AddCoalesced();
 	}
-	scheduleWrite();
 }
 
 void WriteManager::writeSync(WriteEntry &&entry) {
@@ -107,12 +146,17 @@ void WriteManager::writeNow(WriteEntry &&entry) {
 	const auto safe = path('s');
 	const auto simple = path('0');
 	const auto backup = path('1');
+	const auto size = int64(entry.data.size() + entry.md5.size());
 	QSaveFile save;
 	if (open(save, 's')) {
 		write(save);
+		const auto started = crl::now();
 		if (save.commit()) {
+			AddSynced(1, 1, crl::now() - started);
+			AddWritten(1, size);
 			QFile::remove(simple);
 			QFile::remove(backup);
+			QFile::remove(path('j'));
 			return;
 		}
 		LOG(("Storage Error: Could not commit '%1'.").arg(safe));
@@ -120,11 +164,15 @@ void WriteManager::writeNow(WriteEntry &&entry) {
 	QFile plain;
 	if (open(plain, '0')) {
 		write(plain);
+		const auto started = crl::now();
 		base::Platform::FlushFileData(plain);
+		AddSynced(1, 1, crl::now() - started);
 		plain.close();
 
 		QFile::remove(backup);
 		if (base::Platform::RenameWithOverwrite(simple, safe)) {
+			AddWritten(1, size);
+			QFile::remove(path('j'));
 			return;
 		}
 		QFile::remove(safe);
@@ -134,21 +182,129 @@ void WriteManager::writeNow(WriteEntry &&entry) {
 	}
 }
 
+void WriteManager::append(WriteEntry &&entry) {
+	// The full contents should be written before the journal records.
+	const auto i = ranges::find(_scheduled, entry.base, &WriteEntry::base);
+	if (i != end(_scheduled)) {
+		auto full = std::move(*i);
+		_scheduled.erase(i);
+		writeNow(std::move(full));
+	}
+
+	const auto name = path(entry, 'j');
+	QFile file(name);
+	if (file.exists()) {
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+			LOG(("Storage Error: Could not open '%1' for appending."
+				).arg(name));
+			return;
+		}
+	} else if (!open(file, entry, 'j')) {
+		return;
+	}
+	file.write(entry.data);
+	base::Platform::FlushFileData(file);
+}
+
+void WriteManager::writeScheduled() {
+	writeBatch(takeBatch());
+	if (!_scheduled.empty()) {
+		_weak.with([](WriteManager &that) {
+			that.writeScheduled();
+		});
+	}
+}
+
 void WriteManager::writeSyncAll() {
-	while (writeOneScheduledNow()) {
+	while (!_scheduled.empty()) {
+		writeBatch(takeBatch());
 	}
 }
 
-bool WriteManager::writeOneScheduledNow() {
-	if (_scheduled.empty()) {
-		return false;
+std::vector<WriteEntry> WriteManager::takeBatch() {
+	const auto count = std::min(int(_scheduled.size()), kMaxWriteBatch);
+	auto result = std::vector<WriteEntry>();
+	result.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		result.push_back(std::move(_scheduled.front()));
+		_scheduled.pop_front();
+	}
+	return result;
+}
+
+void WriteManager::writeBatch(std::vector<WriteEntry> &&entries) {
+	if (entries.empty()) {
+		return;
+	} else if (entries.size() == 1) {
+		writeNow(std::move(entries.front()));
+		return;
 	}
 
-	auto entry = std::move(_scheduled.front());
-	_scheduled.pop_front();
+	// Write all the files first and only then flush them to disk,
+	// replacing the old contents by renaming after that.
+	auto written = std::vector<WriteEntry>();
+	auto files = std::vector<std::unique_ptr<QFile>>();
+	written.reserve(entries.size());
+	files.reserve(entries.size());
+	for (auto &entry : entries) {
+		auto file = std::make_unique<QFile>();
+		if (!open(*file, entry, '0')) {
+			writeNow(std::move(entry));
+			continue;
+		}
+		file->write(entry.data);
+		file->write(entry.md5);
+		file->flush();
+		written.push_back(std::move(entry));
+		files.push_back(std::move(file));
+	}
+	syncFiles(files);
+
+	auto bytes = int64(0);
+	for (auto i = 0, count = int(files.size()); i != count; ++i) {
+		const auto &entry = written[i];
+		files[i]->close();
+
+		const auto simple = path(entry, '0');
+		const auto safe = path(entry, 's');
+		QFile::remove(path(entry, '1'));
+		if (base::Platform::RenameWithOverwrite(simple, safe)) {
+			bytes += entry.data.size() + entry.md5.size();
+			QFile::remove(path(entry, 'j'));
+			continue;
+		}
+		QFile::remove(safe);
+		LOG(("Storage Error: Could not rename '%1' to '%2', removing.").arg(
+			simple,
+			safe));
+	}
+	AddWritten(int(files.size()), bytes);
+}
 
-	writeNow(std::move(entry));
-	return true;
+void WriteManager::syncFiles(
+		const std::vector<std::unique_ptr<QFile>> &files) {
+	if (files.empty()) {
+		return;
+	}
+	const auto started = crl::now();
+#ifdef Q_OS_LINUX
+	// Start the write-back of all the files at once, so that the disk
+	// gets the whole batch together and the syncs below only wait for it.
+	for (const auto &file : files) {
+		::sync_file_range(file->handle(), 0, 0, SYNC_FILE_RANGE_WRITE);
+	}
+#endif // Q_OS_LINUX
+	for (const auto &file : files) {
+#ifdef Q_OS_LINUX
+		// Only the contents must be on disk before the rename,
+		// fdatasync() skips the metadata like the modification time.
+		if (::fdatasync(file->handle()) == 0) {
+			continue;
+		}
+#endif // Q_OS_LINUX
+		base::Platform::FlushFileData(*file);
+	}
+	AddSynced(1, int(files.size()), crl::now() - started);
 }
 
 bool WriteManager::writeHeader(const QString &basePath, QFileDevice &file) {
@@ -183,40 +339,55 @@ bool WriteManager::open(File &file, const WriteEntry &entry, char postfix) {
 	return true;
 }
 
-void WriteManager::scheduleWrite() {
-	_weak.with([](WriteManager &that) {
-		that.writeScheduled();
-	});
-}
-
-void WriteManager::writeScheduled() {
-	if (writeOneScheduledNow() && !_scheduled.empty()) {
-		scheduleWrite();
+void AsyncWriteManager::ensureManager() {
+	if (!_manager) {
+		_manager.emplace();
 	}
 }
 
 void AsyncWriteManager::write(WriteEntry &&entry) {
 	Expects(!_finished);
 
-	if (!_manager) {
-		_manager.emplace();
-	}
+	ensureManager();
 	_manager->with([entry = std::move(entry)](WriteManager &manager) mutable {
 		manager.write(std::move(entry));
 	});
+
+	// Collect everything written during kWriteDelay into one batch.
+	if (!_flushTimer) {
+		_flushTimer.emplace([=] { flush(); });
+	}
+	if (!_flushTimer->isActive()) {
+		_flushTimer->callOnce(kWriteDelay);
+	}
+}
+
+void AsyncWriteManager::flush() {
+	if (_manager) {
+		_manager->with([](WriteManager &manager) {
+			manager.writeScheduled();
+		});
+	}
 }
 
 void AsyncWriteManager::writeSync(WriteEntry &&entry) {
 	Expects(!_finished);
 
-	if (!_manager) {
-		_manager.emplace();
-	}
+	ensureManager();
 	_manager->with_sync([&](WriteManager &manager) {
 		manager.writeSync(std::move(entry));
 	});
 }
 
+void AsyncWriteManager::append(WriteEntry &&entry) {
+	Expects(!_finished);
+
+	ensureManager();
+	_manager->with([entry = std::move(entry)](WriteManager &manager) mutable {
+		manager.append(std::move(entry));
+	});
+}
+
 void AsyncWriteManager::sync() {
 	if (_manager) {
 		_manager->with_sync([](WriteManager &manager) {
@@ -226,9 +397,21 @@ void AsyncWriteManager::sync() {
 }
 
 void AsyncWriteManager::stop() {
+	_flushTimer.reset();
 	if (_manager) {
 		sync();
 		_manager.reset();
+
+		const auto stats = GetWriteStats();
+		LOG(("Storage Info: "
+			"%1 files written (%2 bytes), %3 writes coalesced, "
+			"%4 batches synced with %5 syncs in %6 ms."
+			).arg(stats.files
+			).arg(stats.bytes
+			).arg(stats.coalesced
+			).arg(stats.batches
+			).arg(stats.syncs
+			).arg(stats.syncDuration));
 	}
 	_finished = true;
 }
@@ -261,6 +444,10 @@ bool KeyAlreadyUsed(QString &name) {
 	if (QFileInfo::exists(name)) {
 		return true;
 	}
+	name[name.size() - 1] = 'j';
+	if (QFileInfo::exists(name)) {
+		return true;
+	}
 	return false;
 }
 
@@ -287,6 +474,8 @@ void ClearKey(const FileKey &key, const QString &basePath) {
 	QFile::remove(name);
 	name[name.size() - 1] = 's';
 	QFile::remove(name);
+	name[name.size() - 1] = 'j';
+	QFile::remove(name);
 }
 
 bool CheckStreamStatus(QDataStream &stream) {
@@ -664,6 +853,121 @@ bool ReadEncryptedFile(
 	return ReadEncryptedFile(result, ToFilePart(fkey), basePath, key);
 }
 
+struct PrefetchedFile::State {
+	QMutex mutex;
+	QWaitCondition finished;
+	bool done = false;
+	bool success = false;
+	int32 version = 0;
+	QByteArray data;
+};
+
+PrefetchedFile::PrefetchedFile(
+	const QString &name,
+	const QString &basePath,
+	const MTP::AuthKeyPtr &key)
+: _state(std::make_shared<State>()) {
+	crl::async([=, state = _state] {
+		const auto trace = Core::StartupTraceScope(
+			"Storage::PrefetchedFile");
+
+		FileReadDescriptor file;
+		const auto success = ReadEncryptedFile(file, name, basePath, key);
+
+		QMutexLocker lock(&state->mutex);
+		state->done = true;
+		state->success = success;
+		if (success) {
+			state->version = file.version;
+			state->data = file.data;
+		}
+		state->finished.wakeAll();
+	});
+}
+
+bool PrefetchedFile::take(FileReadDescriptor &result) {
+	QMutexLocker lock(&_state->mutex);
+	while (!_state->done) {
+		_state->finished.wait(&_state->mutex);
+	}
+	if (!_state->success) {
+		return false;
+	}
+	result.version = _state->version;
+	result.data = base::take(_state->data);
+	result.buffer.setBuffer(&result.data);
+	result.buffer.open(QIODevice::ReadOnly);
+	result.buffer.seek(sizeof(uint32)); // skip len
+	result.stream.setDevice(&result.buffer);
+	result.stream.setVersion(QDataStream::Qt_5_1);
+	return true;
+}
+
+void AppendEncrypted(
+		const FileKey &fkey,
+		const QString &basePath,
+		EncryptedDescriptor &data,
+		const MTP::AuthKeyPtr &key) {
+	auto record = QByteArray();
+	{
+		QDataStream stream(&record, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream << PrepareEncrypted(data, key);
+	}
+	Manager.append(WriteEntry{
+		.basePath = basePath,
+		.base = basePath + ToFilePart(fkey),
+		.data = std::move(record),
+	});
+}
+
+JournalReadResult ReadEncryptedJournal(
+		const FileKey &fkey,
+		const QString &basePath,
+		const MTP::AuthKeyPtr &key) {
+	auto result = JournalReadResult();
+	const auto name = basePath + ToFilePart(fkey) + 'j';
+	QFile file(name);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return result;
+	}
+	char magic[TdfMagicLen];
+	qint32 version = 0;
+	if (file.read(magic, TdfMagicLen) != TdfMagicLen
+		|| memcmp(magic, TdfMagic, TdfMagicLen)
+		|| file.read((char*)&version, sizeof(version)) != sizeof(version)
+		|| version > AppVersion) {
+		LOG(("App Info: bad journal header in '%1'").arg(name));
+		result.complete = false;
+		return result;
+	}
+	const auto bytes = file.readAll();
+	QDataStream stream(bytes);
+	stream.setVersion(QDataStream::Qt_5_1);
+	while (!stream.atEnd()) {
+		auto encrypted = QByteArray();
+		stream >> encrypted;
+
+		// A record could be written only partially before a crash.
+		EncryptedDescriptor data;
+		if (stream.status() != QDataStream::Ok
+			|| !DecryptLocal(data, encrypted, key)) {
+			LOG(("App Info: journal '%1' is broken after %2 records"
+				).arg(name
+				).arg(result.records.size()));
+			result.complete = false;
+			break;
+		}
+		result.records.push_back(data.data.mid(sizeof(uint32)));
+	}
+	return result;
+}
+
+WriteStats GetWriteStats() {
+	QMutexLocker lock(&StatsMutex);
+	return Stats;
+}
+
 void Sync() {
 	Manager.sync();
 }
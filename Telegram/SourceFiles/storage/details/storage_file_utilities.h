@@ -106,6 +106,55 @@ bool ReadEncryptedFile(
 	const QString &basePath,
 	const MTP::AuthKeyPtr &key);
 
+// Reads and decrypts the file on the thread pool right away,
+// take() waits for the result and fills it like ReadEncryptedFile().
+class PrefetchedFile final {
+public:
+	PrefetchedFile(
+		const QString &name,
+		const QString &basePath,
+		const MTP::AuthKeyPtr &key);
+
+	[[nodiscard]] bool take(FileReadDescriptor &result);
+
+private:
+	struct State;
+
+	const std::shared_ptr<State> _state;
+
+};
+
+// Small encrypted delta records appended after the full file contents.
+// Any full write of the same key removes its journal.
+void AppendEncrypted(
+	const FileKey &fkey,
+	const QString &basePath,
+	EncryptedDescriptor &data,
+	const MTP::AuthKeyPtr &key);
+
+struct JournalReadResult {
+	std::vector<QByteArray> records;
+	bool complete = true;
+};
+
+[[nodiscard]] JournalReadResult ReadEncryptedJournal(
+	const FileKey &fkey,
+	const QString &basePath,
+	const MTP::AuthKeyPtr &key);
+
+// Counters of the background writer. Regular writes are delayed a little
+// so that repeated writes of the same file are coalesced and all the files
+// written together are flushed to disk at once.
+struct WriteStats {
+	int64 files = 0;
+	int64 bytes = 0;
+	int64 coalesced = 0;
+	int64 batches = 0;
+	int64 syncs = 0;
+	crl::time syncDuration = 0;
+};
+[[nodiscard]] WriteStats GetWriteStats();
+
 void Sync();
 void Finish();
 
@@ -15,10 +15,13 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "core/file_location.h"
 #include "storage/storage_account.h"
+#include "storage/storage_cache_budget.h"
 #include "storage/file_download_mtproto.h"
 #include "storage/file_download_web.h"
 #include "platform/platform_file_utilities.h"
 #include "main/main_session.h"
+#include "main/main_account.h"
+#include "main/main_domain.h"
 #include "apiwrap.h"
 #include "core/crash_reports.h"
 #include "base/bytes.h"
@@ -214,9 +217,21 @@ void FileLoader::localLoaded(
 		const QImage &imageData) {
 	_localLoading = nullptr;
 	if (result.data.isEmpty()) {
+		if (loadLocalFromOtherAccount()) {
+			return;
+		}
 		_localStatus = LocalStatus::NotFound;
 		start();
 		return;
+	} else if (_localTriedAccounts.empty()) {
+		_session->data().cacheBudget().used(cacheKey());
+	} else {
+		// Found in the cache of some other account, copy it to ours.
+		_session->data().cacheBudget().put(
+			cacheKey(),
+			Storage::Cache::Database::TaggedValue(
+				base::duplicate(result.data),
+				_cacheTag));
 	}
 	const auto partial = result.data.startsWith("partial:");
 	constexpr auto kPrefix = 8;
@@ -265,7 +280,9 @@ bool FileLoader::checkForOpen() {
 	return false;
 }
 
-void FileLoader::loadLocal(const Storage::Cache::Key &key) {
+void FileLoader::loadLocal(
+		const Storage::Cache::Key &key,
+		not_null<Main::Session*> from) {
 	const auto readImage = (_locationType != AudioFileLocation);
 	auto done = [=, guard = _localLoading.make_guard()](
 			QByteArray &&value,
@@ -283,7 +300,7 @@ void FileLoader::loadLocal(const Storage::Cache::Key &key) {
 				std::move(image));
 		});
 	};
-	_session->data().cache().get(key, [=, callback = std::move(done)](
+	from->data().cache().get(key, [=, callback = std::move(done)](
 			QByteArray &&value) mutable {
 		if (readImage && !value.startsWith("partial:")) {
 			crl::async([
@@ -307,6 +324,26 @@ void FileLoader::loadLocal(const Storage::Cache::Key &key) {
 	});
 }
 
+bool FileLoader::loadLocalFromOtherAccount() {
+	// Documents and photos have the same cache keys in all the accounts,
+	// so a file received by several of them is downloaded only once.
+	const auto key = cacheKey();
+	if (_toCache != LoadToCacheAsWell || (!key.low && !key.high)) {
+		return false;
+	}
+	for (const auto &[index, account] : Core::App().domain().accounts()) {
+		if (account.get() == &_session->account()
+			|| !account->sessionExists()
+			|| _localTriedAccounts.contains(index)) {
+			continue;
+		}
+		_localTriedAccounts.emplace(index);
+		loadLocal(key, &account->session());
+		return true;
+	}
+	return false;
+}
+
 bool FileLoader::tryLoadLocal() {
 	if (_localStatus == LocalStatus::NotFound
 		|| _localStatus == LocalStatus::Loaded) {
@@ -318,7 +355,7 @@ bool FileLoader::tryLoadLocal() {
 	if (_toCache == LoadToCacheAsWell) {
 		const auto key = cacheKey();
 		if (key.low || key.high) {
-			loadLocal(key);
+			loadLocal(key, _session);
 			notifyAboutProgress();
 		}
 	}
@@ -462,7 +499,7 @@ bool FileLoader::finalizeResult() {
 		if ((_toCache == LoadToCacheAsWell)
 			&& (_data.size() <= Storage::kMaxFileInMemory)
 			&& (key.low || key.high)) {
-			_session->data().cache().put(
+			_session->data().cacheBudget().put(
 				cacheKey(),
 				Storage::Cache::Database::TaggedValue(
 					base::duplicate((!_fullSize || _data.size() == _fullSize)
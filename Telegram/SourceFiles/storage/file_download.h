@@ -135,7 +135,10 @@ protected:
 
 	bool checkForOpen();
 	bool tryLoadLocal();
-	void loadLocal(const Storage::Cache::Key &key);
+	void loadLocal(
+		const Storage::Cache::Key &key,
+		not_null<Main::Session*> from);
+	bool loadLocalFromOtherAccount();
 	virtual Storage::Cache::Key cacheKey() const = 0;
 	virtual std::optional<MediaKey> fileLocationKey() const = 0;
 	virtual void cancelHook() = 0;
@@ -175,6 +178,7 @@ protected:
 	LocationType _locationType = LocationType();
 
 	base::binary_guard _localLoading;
+	base::flat_set<int> _localTriedAccounts;
 	mutable QByteArray _imageFormat;
 	mutable QImage _imageData;
 
@@ -25,6 +25,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 #include "core/application.h"
 #include "core/file_location.h"
+#include "core/core_startup_trace.h"
 #include "data/stickers/data_stickers.h"
 #include "data/data_session.h"
 #include "data/data_document.h"
@@ -40,6 +41,8 @@ using namespace details;
 using Database = Cache::Database;
 
 constexpr auto kDelayedWriteTimeout = crl::time(1000);
+constexpr auto kMinLocationsJournalRecords = 128;
+constexpr auto kValidateLocationsDelay = 30 * crl::time(1000);
 
 constexpr auto kStickersVersionTag = quint32(-1);
 constexpr auto kStickersSerializeVersion = 1;
@@ -53,6 +56,11 @@ constexpr auto kSinglePeerTypeSelf = qint32(4);
 constexpr auto kSinglePeerTypeEmpty = qint32(0);
 constexpr auto kMultiDraftTag = quint64(0xFFFFFFFFFFFFFF01ULL);
 
+constexpr auto kCachedMessagesTag = quint64(0xFFFFFFFFFFFFFF02ULL);
+constexpr auto kMaxCachedMessagesChats = 64;
+constexpr auto kMaxCachedMessagesSize = 512 * 1024;
+constexpr auto kChatListSnapshotTag = quint64(0xFFFFFFFFFFFFFF03ULL);
+
 enum { // Local Storage Keys
 	lskUserMap = 0x00,
 	lskDraft = 0x01, // data: PeerId peer
@@ -77,8 +85,59 @@ enum { // Local Storage Keys
 	lskBackgroundOld = 0x14, // no data
 	lskSelfSerialized = 0x15, // serialized self
 	lskMasksKeys = 0x16, // no data
+	lskCachedMessages = 0x17, // data: PeerId peer
+	lskChatListSnapshot = 0x18, // no data
 };
 
+template <typename Type>
+[[nodiscard]] QByteArray SerializeTL(const Type &data) {
+	auto buffer = mtpBuffer();
+	buffer.reserve(tl::count_length(data) / sizeof(mtpPrime));
+	data.write(buffer);
+	return QByteArray(
+		reinterpret_cast<const char*>(buffer.constData()),
+		buffer.size() * sizeof(mtpPrime));
+}
+
+template <typename Type>
+[[nodiscard]] std::optional<Type> DeserializeTL(const QByteArray &data) {
+	if (data.isEmpty() || data.size() % sizeof(mtpPrime)) {
+		return std::nullopt;
+	}
+	auto from = reinterpret_cast<const mtpPrime*>(data.constData());
+	const auto till = from + (data.size() / sizeof(mtpPrime));
+	auto result = Type();
+	if (!result.read(from, till) || from != till) {
+		return std::nullopt;
+	}
+	return result;
+}
+
+[[nodiscard]] uint32 LocationSize(const Core::FileLocation &location) {
+	return Serialize::stringSize(location.name())
+		+ Serialize::bytearraySize(location.bookmark())
+		+ Serialize::dateTimeSize()
+		+ sizeof(quint32);
+}
+
+void WriteLocation(QDataStream &stream, const Core::FileLocation &location) {
+	stream
+		<< location.name()
+		<< location.bookmark()
+		<< location.modified
+		<< quint32(location.size);
+}
+
+[[nodiscard]] Core::FileLocation ReadLocation(QDataStream &stream) {
+	auto result = Core::FileLocation();
+	auto bookmark = QByteArray();
+	auto size = quint32();
+	stream >> result.fname >> bookmark >> result.modified >> size;
+	result.size = size;
+	result.setBookmark(bookmark);
+	return result;
+}
+
 [[nodiscard]] FileKey ComputeDataNameKey(const QString &dataName) {
 	// We dropped old test authorizations when migrated to multi auth.
 	//const auto testAddition = (cTestMode() ? qsl(":/test/") : QString());
@@ -119,7 +178,8 @@ Account::Account(not_null<Main::Account*> owner, const QString &dataName)
 , _cacheTotalTimeLimit(Database::Settings().totalTimeLimit)
 , _cacheBigFileTotalTimeLimit(Database::Settings().totalTimeLimit)
 , _writeMapTimer([=] { writeMap(); })
-, _writeLocationsTimer([=] { writeLocations(); }) {
+, _writeLocationsTimer([=] { writeLocations(); })
+, _validateLocationsTimer([=] { validateLocations(); }) {
 }
 
 Account::~Account() {
@@ -184,6 +244,7 @@ base::flat_set<QString> Account::collectGoodNames() const {
 		_legacyBackgroundKeyDay,
 		_recentHashtagsAndBotsKey,
 		_exportSettingsKey,
+		_chatListSnapshotKey,
 		_trustedBotsKey,
 		_installedMasksKey,
 		_recentMasksKey,
@@ -205,6 +266,8 @@ base::flat_set<QString> Account::collectGoodNames() const {
 		result.emplace(name);
 		name[name.size() - 1] = 's';
 		result.emplace(name);
+		name[name.size() - 1] = 'j';
+		result.emplace(name);
 	};
 	for (const auto &[key, value] : _draftsMap) {
 		push(value);
@@ -212,6 +275,9 @@ base::flat_set<QString> Account::collectGoodNames() const {
 	for (const auto &[key, value] : _draftCursorsMap) {
 		push(value);
 	}
+	for (const auto &[key, value] : _cachedMessagesKeys) {
+		push(value);
+	}
 	for (const auto &value : keys) {
 		push(value);
 	}
@@ -221,6 +287,7 @@ base::flat_set<QString> Account::collectGoodNames() const {
 Account::ReadMapResult Account::readMapWith(
 		MTP::AuthKeyPtr localKey,
 		const QByteArray &legacyPasscode) {
+	const auto trace = Core::StartupTraceScope("Storage::Account::readMap");
 	auto ms = crl::now();
 
 	FileReadDescriptor mapData;
@@ -265,6 +332,7 @@ Account::ReadMapResult Account::readMapWith(
 	base::flat_map<PeerId, FileKey> draftsMap;
 	base::flat_map<PeerId, FileKey> draftCursorsMap;
 	base::flat_map<PeerId, bool> draftsNotReadMap;
+	std::vector<std::pair<PeerId, FileKey>> cachedMessagesKeys;
 	quint64 locationsKey = 0, reportSpamStatusesKey = 0, trustedBotsKey = 0;
 	quint64 recentStickersKeyOld = 0;
 	quint64 installedStickersKey = 0, featuredStickersKey = 0, recentStickersKey = 0, favedStickersKey = 0, archivedStickersKey = 0;
@@ -272,6 +340,7 @@ Account::ReadMapResult Account::readMapWith(
 	quint64 savedGifsKey = 0;
 	quint64 legacyBackgroundKeyDay = 0, legacyBackgroundKeyNight = 0;
 	quint64 userSettingsKey = 0, recentHashtagsAndBotsKey = 0, exportSettingsKey = 0;
+	quint64 chatListSnapshotKey = 0;
 	while (!map.stream.atEnd()) {
 		quint32 keyType;
 		map.stream >> keyType;
@@ -291,6 +360,18 @@ Account::ReadMapResult Account::readMapWith(
 		case lskSelfSerialized: {
 			map.stream >> selfSerialized;
 		} break;
+		case lskCachedMessages: {
+			quint32 count = 0;
+			map.stream >> count;
+			for (quint32 i = 0; i < count; ++i) {
+				FileKey key;
+				quint64 peerIdSerialized;
+				map.stream >> key >> peerIdSerialized;
+				cachedMessagesKeys.emplace_back(
+					DeserializePeerId(peerIdSerialized),
+					key);
+			}
+		} break;
 		case lskDraftPosition: {
 			quint32 count = 0;
 			map.stream >> count;
@@ -365,6 +446,9 @@ Account::ReadMapResult Account::readMapWith(
 		case lskExportSettings: {
 			map.stream >> exportSettingsKey;
 		} break;
+		case lskChatListSnapshot: {
+			map.stream >> chatListSnapshotKey;
+		} break;
 		case lskMasksKeys: {
 			map.stream
 				>> installedMasksKey
@@ -385,6 +469,7 @@ Account::ReadMapResult Account::readMapWith(
 	_draftsMap = draftsMap;
 	_draftCursorsMap = draftCursorsMap;
 	_draftsNotReadMap = draftsNotReadMap;
+	_cachedMessagesKeys = std::move(cachedMessagesKeys);
 
 	_locationsKey = locationsKey;
 	_trustedBotsKey = trustedBotsKey;
@@ -403,6 +488,7 @@ Account::ReadMapResult Account::readMapWith(
 	_settingsKey = userSettingsKey;
 	_recentHashtagsAndBotsKey = recentHashtagsAndBotsKey;
 	_exportSettingsKey = exportSettingsKey;
+	_chatListSnapshotKey = chatListSnapshotKey;
 	_oldMapVersion = mapData.version;
 
 	if (_oldMapVersion < AppVersion) {
@@ -411,9 +497,13 @@ Account::ReadMapResult Account::readMapWith(
 		_mapChanged = false;
 	}
 
+	const auto mapDone = crl::now();
+	prefetchFiles();
+
 	if (_locationsKey) {
 		readLocations();
 	}
+	const auto locationsDone = crl::now();
 	if (_legacyBackgroundKeyDay || _legacyBackgroundKeyNight) {
 		Local::moveLegacyBackground(
 			_basePath,
@@ -423,7 +513,9 @@ Account::ReadMapResult Account::readMapWith(
 	}
 
 	auto stored = readSessionSettings();
+	const auto settingsDone = crl::now();
 	readMtpData();
+	const auto mtpDone = crl::now();
 
 	DEBUG_LOG(("selfSerialized set: %1").arg(selfSerialized.size()));
 	_owner->setSessionFromStorage(
@@ -431,11 +523,55 @@ Account::ReadMapResult Account::readMapWith(
 		std::move(selfSerialized),
 		_oldMapVersion);
 
-	LOG(("Map read time: %1").arg(crl::now() - ms));
+	const auto now = crl::now();
+	LOG(("Map read time: %1 (map %2, locations %3, settings %4, "
+		"mtp %5, session %6)"
+		).arg(now - ms
+		).arg(mapDone - ms
+		).arg(locationsDone - mapDone
+		).arg(settingsDone - locationsDone
+		).arg(mtpDone - settingsDone
+		).arg(now - mtpDone));
 
 	return ReadMapResult::Success;
 }
 
+void Account::prefetchFiles() {
+	// Independent files are decrypted in parallel while the previous
+	// ones are parsed. Stickers and saved gifs are read right after the
+	// session is created, so they are prefetched here as well.
+	const auto prefetch = [&](FileKey key, const QString &basePath) {
+		if (key) {
+			_prefetched.emplace(
+				key,
+				std::make_unique<PrefetchedFile>(
+					ToFilePart(key),
+					basePath,
+					_localKey));
+		}
+	};
+	prefetch(_locationsKey, _basePath);
+	prefetch(_settingsKey, _basePath);
+	prefetch(_dataNameKey, BaseGlobalPath());
+	prefetch(_installedStickersKey, _basePath);
+	prefetch(_featuredStickersKey, _basePath);
+	prefetch(_recentStickersKey, _basePath);
+	prefetch(_favedStickersKey, _basePath);
+	prefetch(_installedMasksKey, _basePath);
+	prefetch(_recentMasksKey, _basePath);
+	prefetch(_savedGifsKey, _basePath);
+}
+
+bool Account::readEncryptedFile(
+		FileReadDescriptor &result,
+		FileKey key,
+		const QString &basePath) {
+	if (const auto prefetched = _prefetched.take(key)) {
+		return (*prefetched)->take(result);
+	}
+	return ReadEncryptedFile(result, key, basePath, _localKey);
+}
+
 void Account::writeMapDelayed() {
 	_mapChanged = true;
 	_writeMapTimer.callOnce(kDelayedWriteTimeout);
@@ -491,6 +627,7 @@ void Account::writeMap() {
 	if (!self.isEmpty()) mapSize += sizeof(quint32) + Serialize::bytearraySize(self);
 	if (!_draftsMap.empty()) mapSize += sizeof(quint32) * 2 + _draftsMap.size() * sizeof(quint64) * 2;
 	if (!_draftCursorsMap.empty()) mapSize += sizeof(quint32) * 2 + _draftCursorsMap.size() * sizeof(quint64) * 2;
+	if (!_cachedMessagesKeys.empty()) mapSize += sizeof(quint32) * 2 + _cachedMessagesKeys.size() * sizeof(quint64) * 2;
 	if (_locationsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_trustedBotsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_recentStickersKeyOld) mapSize += sizeof(quint32) + sizeof(quint64);
@@ -502,6 +639,7 @@ void Account::writeMap() {
 	if (_settingsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_recentHashtagsAndBotsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_exportSettingsKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (_chatListSnapshotKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_installedMasksKey || _recentMasksKey || _archivedMasksKey) {
 		mapSize += sizeof(quint32) + 3 * sizeof(quint64);
 	}
@@ -522,6 +660,12 @@ void Account::writeMap() {
 			mapData.stream << quint64(value) << SerializePeerId(key);
 		}
 	}
+	if (!_cachedMessagesKeys.empty()) {
+		mapData.stream << quint32(lskCachedMessages) << quint32(_cachedMessagesKeys.size());
+		for (const auto &[key, value] : _cachedMessagesKeys) {
+			mapData.stream << quint64(value) << SerializePeerId(key);
+		}
+	}
 	if (_locationsKey) {
 		mapData.stream << quint32(lskLocations) << quint64(_locationsKey);
 	}
@@ -550,6 +694,9 @@ void Account::writeMap() {
 	if (_exportSettingsKey) {
 		mapData.stream << quint32(lskExportSettings) << quint64(_exportSettingsKey);
 	}
+	if (_chatListSnapshotKey) {
+		mapData.stream << quint32(lskChatListSnapshot) << quint64(_chatListSnapshotKey);
+	}
 	if (_installedMasksKey || _recentMasksKey || _archivedMasksKey) {
 		mapData.stream << quint32(lskMasksKeys);
 		mapData.stream
@@ -567,6 +714,8 @@ void Account::reset() {
 	_draftsMap.clear();
 	_draftCursorsMap.clear();
 	_draftsNotReadMap.clear();
+	_cachedMessagesKeys.clear();
+	_prefetched.clear();
 	_locationsKey = _trustedBotsKey = 0;
 	_recentStickersKeyOld = 0;
 	_installedStickersKey = 0;
@@ -580,10 +729,12 @@ void Account::reset() {
 	_archivedMasksKey = 0;
 	_legacyBackgroundKeyDay = _legacyBackgroundKeyNight = 0;
 	_settingsKey = _recentHashtagsAndBotsKey = _exportSettingsKey = 0;
+	_chatListSnapshotKey = 0;
 	_oldMapVersion = 0;
 	_fileLocations.clear();
 	_fileLocationPairs.clear();
 	_fileLocationAliases.clear();
+	clearLocationsJournal();
 	_cacheTotalSizeLimit = Database::Settings().totalSizeLimit;
 	_cacheTotalTimeLimit = Database::Settings().totalTimeLimit;
 	_cacheBigFileTotalSizeLimit = Database::Settings().totalSizeLimit;
@@ -615,13 +766,21 @@ void Account::writeLocations() {
 	}
 	_locationsChanged = false;
 
+	const auto compact = _locationsCompactRequired
+		|| (_locationsJournalRecords >= std::max(
+			kMinLocationsJournalRecords,
+			int(_fileLocations.size())));
 	if (_fileLocations.isEmpty()) {
+		clearLocationsJournal();
 		if (_locationsKey) {
 			ClearKey(_locationsKey, _basePath);
 			_locationsKey = 0;
 			writeMapDelayed();
 		}
+	} else if (_locationsKey && !compact) {
+		appendLocationsJournal();
 	} else {
+		clearLocationsJournal();
 		if (!_locationsKey) {
 			_locationsKey = GenerateKey(_basePath);
 			writeMapQueued();
@@ -677,6 +836,106 @@ void Account::writeLocations() {
 	}
 }
 
+void Account::appendLocationsJournal() {
+	if (_locationsJournalKeys.empty() && _locationsJournalAliases.empty()) {
+		return;
+	}
+	auto size = sizeof(quint32) * 2;
+	for (const auto &key : _locationsJournalKeys) {
+		size += sizeof(quint64) * 2 + sizeof(quint32);
+		for (auto i = _fileLocations.constFind(key)
+			; (i != _fileLocations.cend()) && (i.key() == key)
+			; ++i) {
+			size += LocationSize(i.value());
+		}
+	}
+	size += _locationsJournalAliases.size() * sizeof(quint64) * 4;
+
+	// Each record has the full list of locations for the changed keys.
+	EncryptedDescriptor data(size);
+	data.stream << quint32(_locationsJournalKeys.size());
+	for (const auto &key : _locationsJournalKeys) {
+		data.stream
+			<< quint64(key.first)
+			<< quint64(key.second)
+			<< quint32(_fileLocations.count(key));
+		for (auto i = _fileLocations.constFind(key)
+			; (i != _fileLocations.cend()) && (i.key() == key)
+			; ++i) {
+			WriteLocation(data.stream, i.value());
+		}
+	}
+	data.stream << quint32(_locationsJournalAliases.size());
+	for (const auto &[alias, location] : _locationsJournalAliases) {
+		data.stream
+			<< quint64(alias.first)
+			<< quint64(alias.second)
+			<< quint64(location.first)
+			<< quint64(location.second);
+	}
+	AppendEncrypted(_locationsKey, _basePath, data, _localKey);
+
+	_locationsJournalKeys.clear();
+	_locationsJournalAliases.clear();
+	++_locationsJournalRecords;
+}
+
+bool Account::applyLocationsJournal(const QByteArray &record) {
+	QDataStream stream(record);
+	stream.setVersion(QDataStream::Qt_5_1);
+
+	auto keys = quint32();
+	stream >> keys;
+	for (auto i = quint32(); i != keys && !stream.atEnd(); ++i) {
+		auto first = quint64(), second = quint64();
+		auto count = quint32();
+		stream >> first >> second >> count;
+		const auto key = MediaKey(first, second);
+		for (auto j = _fileLocations.find(key)
+			; (j != _fileLocations.end()) && (j.key() == key)
+			;) {
+			const auto k = _fileLocationPairs.find(j.value().fname);
+			if (k != _fileLocationPairs.end() && k.value().first == key) {
+				_fileLocationPairs.erase(k);
+			}
+			j = _fileLocations.erase(j);
+		}
+		for (auto j = quint32(); j != count && !stream.atEnd(); ++j) {
+			const auto location = ReadLocation(stream);
+			_fileLocations.insert(key, location);
+			if (!location.inMediaCache()) {
+				_fileLocationPairs.insert(location.fname, { key, location });
+			}
+		}
+	}
+	auto aliases = quint32();
+	stream >> aliases;
+	for (auto i = quint32(); i != aliases && !stream.atEnd(); ++i) {
+		auto kfirst = quint64(), ksecond = quint64();
+		auto vfirst = quint64(), vsecond = quint64();
+		stream >> kfirst >> ksecond >> vfirst >> vsecond;
+		_fileLocationAliases.insert(
+			MediaKey(kfirst, ksecond),
+			MediaKey(vfirst, vsecond));
+	}
+	return CheckStreamStatus(stream);
+}
+
+void Account::journalLocation(MediaKey location) {
+	_locationsJournalKeys.emplace(location);
+}
+
+void Account::journalLocationAlias(MediaKey alias, MediaKey location) {
+	_locationsJournalAliases.emplace_back(alias, location);
+}
+
+void Account::clearLocationsJournal() {
+	_locationsJournalKeys.clear();
+	_locationsJournalAliases.clear();
+	_locationsJournalRecords = 0;
+	_locationsCompactRequired = false;
+}
+
 void Account::writeLocationsQueued() {
 	_locationsChanged = true;
 	crl::on_main(_owner, [=] {
@@ -690,8 +949,11 @@ void Account::writeLocationsDelayed() {
 }
 
 void Account::readLocations() {
+	const auto trace = Core::StartupTraceScope(
+		"Storage::Account::readLocations");
+
 	FileReadDescriptor locations;
-	if (!ReadEncryptedFile(locations, _locationsKey, _basePath, _localKey)) {
+	if (!readEncryptedFile(locations, _locationsKey, _basePath)) {
 		ClearKey(_locationsKey, _basePath);
 		_locationsKey = 0;
 		writeMapDelayed();
@@ -745,6 +1007,75 @@ void Account::readLocations() {
 			}
 		}
 	}
+
+	const auto journal = ReadEncryptedJournal(
+		_locationsKey,
+		_basePath,
+		_localKey);
+	auto complete = journal.complete;
+	for (const auto &record : journal.records) {
+		if (!applyLocationsJournal(record)) {
+			complete = false;
+			break;
+		}
+		++_locationsJournalRecords;
+	}
+	if (!complete) {
+		// Write everything we could read and start a new journal.
+		_locationsCompactRequired = true;
+		writeLocationsDelayed();
+	}
+	_validateLocationsTimer.callOnce(kValidateLocationsDelay);
+}
+
+void Account::validateLocations() {
+	// Bookmarked locations need sandbox access, they're checked on use.
+	auto list = std::vector<std::pair<MediaKey, Core::FileLocation>>();
+	list.reserve(_fileLocations.size());
+	for (auto i = _fileLocations.cbegin(); i != _fileLocations.cend(); ++i) {
+		if (!i.value().inMediaCache() && i.value().bookmark().isEmpty()) {
+			list.emplace_back(i.key(), i.value());
+		}
+	}
+	if (list.empty()) {
+		return;
+	}
+	const auto weak = base::make_weak(_owner.get());
+	crl::async([=, list = std::move(list)] {
+		auto stale = std::vector<std::pair<MediaKey, Core::FileLocation>>();
+		for (const auto &[key, location] : list) {
+			if (!location.check()) {
+				stale.emplace_back(key, location);
+			}
+		}
+		if (!stale.empty()) {
+			crl::on_main(weak, [=, stale = std::move(stale)] {
+				removeStaleLocations(stale);
+			});
+		}
+	});
+}
+
+void Account::removeStaleLocations(
+		const std::vector<std::pair<MediaKey, Core::FileLocation>> &stale) {
+	for (const auto &[key, location] : stale) {
+		for (auto i = _fileLocations.find(key)
+			; (i != _fileLocations.end()) && (i.key() == key)
+			; ++i) {
+			if (i.value() == location) {
+				const auto j = _fileLocationPairs.find(location.fname);
+				if (j != _fileLocationPairs.end() && j.value().first == key) {
+					_fileLocationPairs.erase(j);
+				}
+				_fileLocations.erase(i);
+				journalLocation(key);
+				break;
+			}
+		}
+	}
+	DEBUG_LOG(("App Info: %1 stale file locations removed."
+		).arg(stale.size()));
+	writeLocationsDelayed();
 }
 
 void Account::writeSessionSettings() {
@@ -808,9 +1139,12 @@ ReadSettingsContext Account::prepareReadSettingsContext() const {
 }
 
 std::unique_ptr<Main::SessionSettings> Account::readSessionSettings() {
+	const auto trace = Core::StartupTraceScope(
+		"Storage::Account::readSessionSettings");
+
 	ReadSettingsContext context;
 	FileReadDescriptor userSettings;
-	if (!ReadEncryptedFile(userSettings, _settingsKey, _basePath, _localKey)) {
+	if (!readEncryptedFile(userSettings, _settingsKey, _basePath)) {
 		LOG(("App Info: could not read encrypted user settings..."));
 
 		Local::readOldUserSettings(true, context);
@@ -896,10 +1230,13 @@ void Account::writeMtpData() {
 }
 
 void Account::readMtpData() {
+	const auto trace = Core::StartupTraceScope(
+		"Storage::Account::readMtpData");
+
 	auto context = prepareReadSettingsContext();
 
 	FileReadDescriptor mtp;
-	if (!ReadEncryptedFile(mtp, ToFilePart(_dataNameKey), BaseGlobalPath(), _localKey)) {
+	if (!readEncryptedFile(mtp, _dataNameKey, BaseGlobalPath())) {
 		if (_localKey) {
 			Local::readOldMtpData(true, context);
 			applyReadContext(std::move(context));
@@ -1082,6 +1419,143 @@ void Account::writeDrafts(
 	_draftsNotReadMap.remove(peerId);
 }
 
+void Account::writeCachedMessages(
+		PeerId peerId,
+		const MTPmessages_Messages &messages) {
+	const auto serialized = SerializeTL(messages);
+	if (serialized.size() > kMaxCachedMessagesSize) {
+		removeCachedMessages(peerId);
+		return;
+	}
+	const auto i = ranges::find(
+		_cachedMessagesKeys,
+		peerId,
+		&std::pair<PeerId, FileKey>::first);
+	auto key = FileKey();
+	if (i != end(_cachedMessagesKeys)) {
+		key = i->second;
+		_cachedMessagesKeys.erase(i);
+	} else {
+		key = GenerateKey(_basePath);
+		while (_cachedMessagesKeys.size() >= kMaxCachedMessagesChats) {
+			ClearKey(_cachedMessagesKeys.front().second, _basePath);
+			_cachedMessagesKeys.erase(begin(_cachedMessagesKeys));
+		}
+	}
+	_cachedMessagesKeys.emplace_back(peerId, key);
+	writeMapDelayed();
+
+	EncryptedDescriptor data(sizeof(quint64) * 2
+		+ Serialize::bytearraySize(serialized));
+	data.stream
+		<< quint64(kCachedMessagesTag)
+		<< SerializePeerId(peerId)
+		<< serialized;
+
+	FileWriteDescriptor file(key, _basePath);
+	file.writeEncrypted(data, _localKey);
+}
+
+std::optional<MTPmessages_Messages> Account::readCachedMessages(
+		PeerId peerId) {
+	const auto i = ranges::find(
+		_cachedMessagesKeys,
+		peerId,
+		&std::pair<PeerId, FileKey>::first);
+	if (i == end(_cachedMessagesKeys)) {
+		return std::nullopt;
+	}
+	FileReadDescriptor cached;
+	if (!ReadEncryptedFile(cached, i->second, _basePath, _localKey)) {
+		removeCachedMessages(peerId);
+		return std::nullopt;
+	}
+	quint64 tag = 0, peerIdSerialized = 0;
+	QByteArray serialized;
+	cached.stream >> tag >> peerIdSerialized >> serialized;
+	auto result = (CheckStreamStatus(cached.stream)
+		&& tag == kCachedMessagesTag
+		&& DeserializePeerId(peerIdSerialized) == peerId)
+		? DeserializeTL<MTPmessages_Messages>(serialized)
+		: std::nullopt;
+	if (!result) {
+		LOG(("App Error: could not read cached messages for peer %1."
+			).arg(peerId.value));
+		removeCachedMessages(peerId);
+	}
+	return result;
+}
+
+void Account::removeCachedMessages(PeerId peerId) {
+	const auto i = ranges::find(
+		_cachedMessagesKeys,
+		peerId,
+		&std::pair<PeerId, FileKey>::first);
+	if (i != end(_cachedMessagesKeys)) {
+		ClearKey(i->second, _basePath);
+		_cachedMessagesKeys.erase(i);
+		writeMapDelayed();
+	}
+}
+
+void Account::writeChatListSnapshot(const ChatListSnapshot &snapshot) {
+	const auto list = SerializeTL(snapshot.list);
+	const auto pinned = SerializeTL(snapshot.pinned);
+	if (!_chatListSnapshotKey) {
+		_chatListSnapshotKey = GenerateKey(_basePath);
+		writeMapQueued();
+	}
+	EncryptedDescriptor data(sizeof(quint64)
+		+ Serialize::bytearraySize(list)
+		+ Serialize::bytearraySize(pinned));
+	data.stream << quint64(kChatListSnapshotTag) << list << pinned;
+
+	FileWriteDescriptor file(_chatListSnapshotKey, _basePath);
+	file.writeEncrypted(data, _localKey);
+}
+
+std::optional<ChatListSnapshot> Account::readChatListSnapshot() {
+	if (!_chatListSnapshotKey) {
+		return std::nullopt;
+	}
+	FileReadDescriptor snapshot;
+	if (!ReadEncryptedFile(
+			snapshot,
+			_chatListSnapshotKey,
+			_basePath,
+			_localKey)) {
+		removeChatListSnapshot();
+		return std::nullopt;
+	}
+	quint64 tag = 0;
+	QByteArray list, pinned;
+	snapshot.stream >> tag >> list >> pinned;
+	if (!CheckStreamStatus(snapshot.stream)
+		|| tag != kChatListSnapshotTag) {
+		removeChatListSnapshot();
+		return std::nullopt;
+	}
+	auto parsedList = DeserializeTL<MTPmessages_Dialogs>(list);
+	auto parsedPinned = DeserializeTL<MTPmessages_PeerDialogs>(pinned);
+	if (!parsedList || !parsedPinned) {
+		LOG(("App Error: could not read the chat list snapshot."));
+		removeChatListSnapshot();
+		return std::nullopt;
+	}
+	return ChatListSnapshot{
+		.list = std::move(*parsedList),
+		.pinned = std::move(*parsedPinned),
+	};
+}
+
+void Account::removeChatListSnapshot() {
+	if (_chatListSnapshotKey) {
+		ClearKey(_chatListSnapshotKey, _basePath);
+		_chatListSnapshotKey = 0;
+		writeMapDelayed();
+	}
+}
+
 void Account::writeDraftCursors(
 		not_null<History*> history,
 		Data::DraftKey replaceKey,
@@ -1391,6 +1865,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 			if (i.value().second == local) {
 				if (i.value().first != location) {
 					_fileLocationAliases.insert(location, i.value().first);
+					journalLocationAlias(location, i.value().first);
 					writeLocationsQueued();
 				}
 				return;
@@ -1402,6 +1877,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 						break;
 					}
 				}
+				journalLocation(i.value().first);
 				_fileLocationPairs.erase(i);
 			}
 		}
@@ -1415,6 +1891,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 		}
 	}
 	_fileLocations.insert(location, local);
+	journalLocation(location);
 	writeLocationsQueued();
 }
 
@@ -1426,6 +1903,7 @@ void Account::removeFileLocation(MediaKey location) {
 	while (i != _fileLocations.end() && (i.key() == location)) {
 		i = _fileLocations.erase(i);
 	}
+	journalLocation(location);
 	writeLocationsQueued();
 }
 
@@ -1439,6 +1917,7 @@ Core::FileLocation Account::readFileLocation(MediaKey location) {
 		if (!i.value().inMediaCache() && !i.value().check()) {
 			_fileLocationPairs.remove(i.value().fname);
 			i = _fileLocations.erase(i);
+			journalLocation(location);
 			writeLocationsDelayed();
 			continue;
 		}
@@ -1658,7 +2137,7 @@ void Account::readStickerSets(
 	using SetFlag = Data::StickersSetFlag;
 
 	FileReadDescriptor stickers;
-	if (!ReadEncryptedFile(stickers, stickersKey, _basePath, _localKey)) {
+	if (!readEncryptedFile(stickers, stickersKey, _basePath)) {
 		ClearKey(stickersKey, _basePath);
 		stickersKey = 0;
 		writeMapDelayed();
@@ -2254,7 +2733,7 @@ void Account::readSavedGifs() {
 	if (!_savedGifsKey) return;
 
 	FileReadDescriptor gifs;
-	if (!ReadEncryptedFile(gifs, _savedGifsKey, _basePath, _localKey)) {
+	if (!readEncryptedFile(gifs, _savedGifsKey, _basePath)) {
 		ClearKey(_savedGifsKey, _basePath);
 		_savedGifsKey = 0;
 		writeMapDelayed();
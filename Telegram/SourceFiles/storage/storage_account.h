@@ -42,6 +42,7 @@ namespace Storage {
 namespace details {
 struct ReadSettingsContext;
 struct FileReadDescriptor;
+class PrefetchedFile;
 } // namespace details
 
 class EncryptionKey;
@@ -56,6 +57,12 @@ struct MessageDraft {
 	Data::PreviewState previewState = Data::PreviewState::Allowed;
 };
 
+// First page of the main chat list as it was received last time.
+struct ChatListSnapshot {
+	MTPmessages_Dialogs list;
+	MTPmessages_PeerDialogs pinned;
+};
+
 class Account final {
 public:
 	Account(not_null<Main::Account*> owner, const QString &dataName);
@@ -91,6 +98,17 @@ public:
 	[[nodiscard]] bool hasDraftCursors(PeerId peerId);
 	[[nodiscard]] bool hasDraft(PeerId peerId);
 
+	void writeCachedMessages(
+		PeerId peerId,
+		const MTPmessages_Messages &messages);
+	[[nodiscard]] std::optional<MTPmessages_Messages> readCachedMessages(
+		PeerId peerId);
+	void removeCachedMessages(PeerId peerId);
+
+	void writeChatListSnapshot(const ChatListSnapshot &snapshot);
+	[[nodiscard]] std::optional<ChatListSnapshot> readChatListSnapshot();
+	void removeChatListSnapshot();
+
 	void writeFileLocation(MediaKey location, const Core::FileLocation &local);
 	[[nodiscard]] Core::FileLocation readFileLocation(MediaKey location);
 	void removeFileLocation(MediaKey location);
@@ -184,10 +202,24 @@ private:
 	void writeMapQueued();
 	void writeMap();
 
+	void prefetchFiles();
+	[[nodiscard]] bool readEncryptedFile(
+		details::FileReadDescriptor &result,
+		FileKey key,
+		const QString &basePath);
+
 	void readLocations();
 	void writeLocations();
 	void writeLocationsQueued();
 	void writeLocationsDelayed();
+	void appendLocationsJournal();
+	[[nodiscard]] bool applyLocationsJournal(const QByteArray &record);
+	void journalLocation(MediaKey location);
+	void journalLocationAlias(MediaKey alias, MediaKey location);
+	void clearLocationsJournal();
+	void validateLocations();
+	void removeStaleLocations(
+		const std::vector<std::pair<MediaKey, Core::FileLocation>> &stale);
 
 	std::unique_ptr<Main::SessionSettings> readSessionSettings();
 	void writeSessionSettings(Main::SessionSettings *stored);
@@ -243,9 +275,22 @@ private:
 	base::flat_map<PeerId, FileKey> _draftCursorsMap;
 	base::flat_map<PeerId, bool> _draftsNotReadMap;
 
-	QMultiMap<MediaKey, Core::FileLocation> _fileLocations;
-	QMap<QString, QPair<MediaKey, Core::FileLocation>> _fileLocationPairs;
-	QMap<MediaKey, MediaKey> _fileLocationAliases;
+	// Most recently written are at the back.
+	std::vector<std::pair<PeerId, FileKey>> _cachedMessagesKeys;
+
+	QMultiHash<MediaKey, Core::FileLocation> _fileLocations;
+	QHash<QString, QPair<MediaKey, Core::FileLocation>> _fileLocationPairs;
+	QHash<MediaKey, MediaKey> _fileLocationAliases;
+
+	// Changes not written to the full locations file yet.
+	base::flat_set<MediaKey> _locationsJournalKeys;
+	std::vector<std::pair<MediaKey, MediaKey>> _locationsJournalAliases;
+	int _locationsJournalRecords = 0;
+	bool _locationsCompactRequired = false;
+
+	base::flat_map<
+		FileKey,
+		std::unique_ptr<details::PrefetchedFile>> _prefetched;
 
 	FileKey _locationsKey = 0;
 	FileKey _trustedBotsKey = 0;
@@ -262,6 +307,7 @@ private:
 	FileKey _settingsKey = 0;
 	FileKey _recentHashtagsAndBotsKey = 0;
 	FileKey _exportSettingsKey = 0;
+	FileKey _chatListSnapshotKey = 0;
 	FileKey _installedMasksKey = 0;
 	FileKey _recentMasksKey = 0;
 
@@ -279,6 +325,7 @@ private:
 
 	base::Timer _writeMapTimer;
 	base::Timer _writeLocationsTimer;
+	base::Timer _validateLocationsTimer;
 	bool _mapChanged = false;
 	bool _locationsChanged = false;
 
@@ -0,0 +1,163 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/storage_cache_budget.h"
+
+namespace Storage {
+namespace {
+
+constexpr auto kMaxTracked = 16 * 1024;
+constexpr auto kEvictUntilPercent = 90;
+
+} // namespace
+
+CacheBudget::CacheBudget(
+	not_null<Cache::Database*> database,
+	int64 totalSizeLimit,
+	std::vector<Quota> quotas)
+: _database(database)
+, _quotas(std::move(quotas))
+, _totalSizeLimit(totalSizeLimit) {
+	for (const auto &quota : _quotas) {
+		_tags[quota.tag].quota = _totalSizeLimit * quota.percent / 100;
+	}
+	_database->statsOnMain(
+	) | rpl::start_with_next([=](const Cache::Database::Stats &stats) {
+		apply(stats);
+	}, _lifetime);
+}
+
+Cache::Database &CacheBudget::database() const {
+	return *_database;
+}
+
+void CacheBudget::setTotalSizeLimit(int64 limit) {
+	QMutexLocker lock(&_mutex);
+	_totalSizeLimit = limit;
+	for (const auto &quota : _quotas) {
+		_tags[quota.tag].quota = _totalSizeLimit * quota.percent / 100;
+	}
+}
+
+void CacheBudget::put(
+		const Cache::Key &key,
+		Cache::Database::TaggedValue &&value) {
+	const auto size = int(value.bytes.size());
+	const auto tag = value.tag;
+	_database->put(key, std::move(value));
+
+	QMutexLocker lock(&_mutex);
+	if (!_tags.contains(tag)) {
+		return;
+	}
+	auto &entry = _entries[key];
+	entry.tag = tag;
+	entry.size = size;
+	entry.used = crl::now();
+	if (_entries.size() > kMaxTracked) {
+		trimTracked();
+	}
+}
+
+void CacheBudget::used(const Cache::Key &key) {
+	QMutexLocker lock(&_mutex);
+	if (const auto i = _entries.find(key); i != end(_entries)) {
+		i->second.used = crl::now();
+	}
+}
+
+auto CacheBudget::stats() const -> base::flat_map<uint8, TagStats> {
+	QMutexLocker lock(&_mutex);
+	return _tags;
+}
+
+rpl::producer<> CacheBudget::statsUpdated() const {
+	return _statsUpdated.events();
+}
+
+void CacheBudget::apply(const Cache::Database::Stats &stats) {
+	auto evicted = std::vector<Cache::Key>();
+	{
+		QMutexLocker lock(&_mutex);
+		for (auto &[tag, tagStats] : _tags) {
+			const auto i = stats.tagged.find(tag);
+			tagStats.size = (i != end(stats.tagged)) ? i->second.totalSize : 0;
+			if (stats.clearing
+				|| !tagStats.quota
+				|| tagStats.size <= tagStats.quota) {
+				continue;
+			}
+			const auto until = tagStats.quota * kEvictUntilPercent / 100;
+			auto chosen = chooseEvicted(tag, tagStats.size - until);
+			evicted.insert(end(evicted), begin(chosen), end(chosen));
+		}
+		for (auto &[tag, tagStats] : _tags) {
+			tagStats.tracked = 0;
+		}
+		for (const auto &[key, entry] : _entries) {
+			++_tags[entry.tag].tracked;
+		}
+	}
+	for (const auto &key : evicted) {
+		_database->remove(key);
+	}
+	_statsUpdated.fire({});
+}
+
+std::vector<Cache::Key> CacheBudget::chooseEvicted(uint8 tag, int64 excess) {
+	// Prefer large entries that were not used for a long time.
+	const auto now = crl::now();
+	const auto score = [&](const Entry &entry) {
+		return double(entry.size) * double(now - entry.used + 1);
+	};
+	auto candidates = std::vector<std::pair<double, Cache::Key>>();
+	for (const auto &[key, entry] : _entries) {
+		if (entry.tag == tag) {
+			candidates.emplace_back(score(entry), key);
+		}
+	}
+	ranges::sort(candidates, ranges::greater(), [](const auto &pair) {
+		return pair.first;
+	});
+
+	auto &tagStats = _tags[tag];
+	auto result = std::vector<Cache::Key>();
+	for (const auto &[score, key] : candidates) {
+		if (excess <= 0) {
+			break;
+		}
+		const auto size = _entries.take(key)->size;
+		excess -= size;
+		++tagStats.evicted;
+		tagStats.evictedSize += size;
+		result.push_back(key);
+	}
+	return result;
+}
+
+void CacheBudget::trimTracked() {
+	// Forget about the least recently used entries,
+	// the database will remove them by itself in time.
+	auto used = std::vector<crl::time>();
+	used.reserve(_entries.size());
+	for (const auto &[key, entry] : _entries) {
+		used.push_back(entry.used);
+	}
+	const auto border = used.begin() + (kMaxTracked / 8);
+	ranges::nth_element(used, border);
+
+	auto kept = base::flat_map<Cache::Key, Entry>();
+	kept.reserve(_entries.size());
+	for (auto &[key, entry] : _entries) {
+		if (entry.used >= *border) {
+			kept.emplace(key, entry);
+		}
+	}
+	_entries = std::move(kept);
+}
+
+} // namespace Storage
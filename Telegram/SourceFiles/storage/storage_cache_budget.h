@@ -0,0 +1,79 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "storage/cache/storage_cache_database.h"
+#include "base/flat_map.h"
+
+#include <QtCore/QMutex>
+
+namespace Storage {
+
+// Per-tag size quotas on top of a cache database.
+//
+// The database has only one size limit for all its contents and removes
+// the oldest entries first, so a few long videos can push out everything
+// else. Entries put through the budget are tracked with their size and
+// last use time, and when the database reports some tag above its quota
+// the largest and coldest of the tracked entries of that tag are removed.
+class CacheBudget final {
+public:
+	struct Quota {
+		uint8 tag = 0;
+		int percent = 100; // Of the database total size limit.
+	};
+	struct TagStats {
+		int64 quota = 0;
+		int64 size = 0;
+		int tracked = 0;
+		int evicted = 0;
+		int64 evictedSize = 0;
+	};
+
+	CacheBudget(
+		not_null<Cache::Database*> database,
+		int64 totalSizeLimit,
+		std::vector<Quota> quotas);
+
+	[[nodiscard]] Cache::Database &database() const;
+	void setTotalSizeLimit(int64 limit);
+
+	// Any thread.
+	void put(const Cache::Key &key, Cache::Database::TaggedValue &&value);
+	void used(const Cache::Key &key);
+
+	[[nodiscard]] base::flat_map<uint8, TagStats> stats() const;
+	[[nodiscard]] rpl::producer<> statsUpdated() const;
+
+private:
+	struct Entry {
+		uint8 tag = 0;
+		int size = 0;
+		crl::time used = 0;
+	};
+
+	void apply(const Cache::Database::Stats &stats);
+	[[nodiscard]] std::vector<Cache::Key> chooseEvicted(
+		uint8 tag,
+		int64 excess);
+	void trimTracked();
+
+	const not_null<Cache::Database*> _database;
+	const std::vector<Quota> _quotas;
+
+	mutable QMutex _mutex;
+	base::flat_map<Cache::Key, Entry> _entries;
+	base::flat_map<uint8, TagStats> _tags;
+	int64 _totalSizeLimit = 0;
+
+	rpl::event_stream<> _statsUpdated;
+	rpl::lifetime _lifetime;
+
+};
+
+} // namespace Storage
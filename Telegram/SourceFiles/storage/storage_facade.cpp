@@ -23,6 +23,11 @@ public:
 	rpl::producer<SharedMediaResult> query(SharedMediaQuery &&query) const;
 	SharedMediaResult snapshot(const SharedMediaQuery &query) const;
 	bool empty(const SharedMediaKey &key) const;
+	QByteArray serialize(PeerId peerId, SharedMediaType type) const;
+	void restore(
+		PeerId peerId,
+		SharedMediaType type,
+		const QByteArray &serialized);
 	rpl::producer<SharedMediaSliceUpdate> sharedMediaSliceUpdated() const;
 	rpl::producer<SharedMediaRemoveOne> sharedMediaOneRemoved() const;
 	rpl::producer<SharedMediaRemoveAll> sharedMediaAllRemoved() const;
@@ -77,6 +82,19 @@ bool Facade::Impl::empty(const SharedMediaKey &key) const {
 	return _sharedMedia.empty(key);
 }
 
+QByteArray Facade::Impl::serialize(
+		PeerId peerId,
+		SharedMediaType type) const {
+	return _sharedMedia.serialize(peerId, type);
+}
+
+void Facade::Impl::restore(
+		PeerId peerId,
+		SharedMediaType type,
+		const QByteArray &serialized) {
+	_sharedMedia.restore(peerId, type, serialized);
+}
+
 rpl::producer<SharedMediaSliceUpdate> Facade::Impl::sharedMediaSliceUpdated() const {
 	return _sharedMedia.sliceUpdated();
 }
@@ -156,6 +174,17 @@ bool Facade::empty(const SharedMediaKey &key) const {
 	return _impl->empty(key);
 }
 
+QByteArray Facade::serialize(PeerId peerId, SharedMediaType type) const {
+	return _impl->serialize(peerId, type);
+}
+
+void Facade::restore(
+		PeerId peerId,
+		SharedMediaType type,
+		const QByteArray &serialized) {
+	_impl->restore(peerId, type, serialized);
+}
+
 rpl::producer<SharedMediaSliceUpdate> Facade::sharedMediaSliceUpdated() const {
 	return _impl->sharedMediaSliceUpdated();
 }
@@ -18,6 +18,7 @@ namespace Storage {
 
 struct SparseIdsListResult;
 
+enum class SharedMediaType : signed char;
 struct SharedMediaAddNew;
 struct SharedMediaAddExisting;
 struct SharedMediaAddSlice;
@@ -51,6 +52,11 @@ public:
 	rpl::producer<SharedMediaResult> query(SharedMediaQuery &&query) const;
 	SharedMediaResult snapshot(const SharedMediaQuery &query) const;
 	bool empty(const SharedMediaKey &key) const;
+	QByteArray serialize(PeerId peerId, SharedMediaType type) const;
+	void restore(
+		PeerId peerId,
+		SharedMediaType type,
+		const QByteArray &serialized);
 	rpl::producer<SharedMediaSliceUpdate> sharedMediaSliceUpdated() const;
 	rpl::producer<SharedMediaRemoveOne> sharedMediaOneRemoved() const;
 	rpl::producer<SharedMediaRemoveAll> sharedMediaAllRemoved() const;
@@ -143,6 +143,30 @@ bool SharedMedia::empty(const SharedMediaKey &key) const {
 	return true;
 }
 
+QByteArray SharedMedia::serialize(
+		PeerId peerId,
+		SharedMediaType type) const {
+	Expects(IsValidSharedMediaType(type));
+
+	auto peerIt = _lists.find(peerId);
+	if (peerIt != _lists.end()) {
+		auto index = static_cast<int>(type);
+		return peerIt->second[index].serialize();
+	}
+	return QByteArray();
+}
+
+void SharedMedia::restore(
+		PeerId peerId,
+		SharedMediaType type,
+		const QByteArray &serialized) {
+	Expects(IsValidSharedMediaType(type));
+
+	auto peerIt = enforceLists(peerId);
+	auto index = static_cast<int>(type);
+	peerIt->second[index].restore(serialized);
+}
+
 rpl::producer<SharedMediaSliceUpdate> SharedMedia::sliceUpdated() const {
 	return _sliceUpdated.events();
 }
@@ -199,6 +199,11 @@ public:
 	rpl::producer<SharedMediaResult> query(SharedMediaQuery &&query) const;
 	SharedMediaResult snapshot(const SharedMediaQuery &query) const;
 	bool empty(const SharedMediaKey &key) const;
+	QByteArray serialize(PeerId peerId, SharedMediaType type) const;
+	void restore(
+		PeerId peerId,
+		SharedMediaType type,
+		const QByteArray &serialized);
 	rpl::producer<SharedMediaSliceUpdate> sliceUpdated() const;
 	rpl::producer<SharedMediaRemoveOne> oneRemoved() const;
 	rpl::producer<SharedMediaRemoveAll> allRemoved() const;
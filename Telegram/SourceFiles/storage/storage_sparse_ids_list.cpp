@@ -8,6 +8,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_sparse_ids_list.h"
 
 namespace Storage {
+namespace {
+
+constexpr auto kSerializeVersion = qint32(1);
+constexpr auto kMaxSerializedIds = 4096;
+
+} // namespace
 
 SparseIdsList::Slice::Slice(
 	base::flat_set<MsgId> &&messages,
@@ -129,8 +135,27 @@ void SparseIdsList::addRange(
 	_sliceUpdated.fire(std::move(update));
 }
 
+template <typename Range>
+void SparseIdsList::confirmRange(
+		const Range &messages,
+		MsgRange noSkipRange) {
+	if (_unconfirmed.empty()) {
+		return;
+	}
+	const auto from = _unconfirmed.lower_bound(noSkipRange.from);
+	const auto till = _unconfirmed.upper_bound(noSkipRange.till);
+	for (auto i = from; i != till; ++i) {
+		if (ranges::find(messages, *i) == std::end(messages)) {
+			// Deleted while we were offline.
+			removeFromSlices(*i);
+		}
+	}
+	_unconfirmed.erase(from, till);
+}
+
 void SparseIdsList::addNew(MsgId messageId) {
 	auto range = { messageId };
+	confirmRange(range, { messageId, ServerMaxMsgId });
 	addRange(range, { messageId, ServerMaxMsgId }, std::nullopt, true);
 }
 
@@ -138,6 +163,7 @@ void SparseIdsList::addExisting(
 		MsgId messageId,
 		MsgRange noSkipRange) {
 	auto range = { messageId };
+	confirmRange(range, noSkipRange);
 	addRange(range, noSkipRange, std::nullopt);
 }
 
@@ -145,10 +171,11 @@ void SparseIdsList::addSlice(
 		std::vector<MsgId> &&messageIds,
 		MsgRange noSkipRange,
 		std::optional<int> count) {
+	confirmRange(messageIds, noSkipRange);
 	addRange(messageIds, noSkipRange, count);
 }
 
-void SparseIdsList::removeOne(MsgId messageId) {
+void SparseIdsList::removeFromSlices(MsgId messageId) {
 	auto slice = ranges::lower_bound(
 		_slices,
 		messageId,
@@ -159,6 +186,14 @@ void SparseIdsList::removeOne(MsgId messageId) {
 			return slice.messages.remove(messageId);
 		});
 	}
+}
+
+void SparseIdsList::removeOne(MsgId messageId) {
+	removeFromSlices(messageId);
+	if (_unconfirmed.remove(messageId)) {
+		// The server count never included it.
+		return;
+	}
 	if (_count) {
 		--*_count;
 	}
@@ -167,6 +202,7 @@ void SparseIdsList::removeOne(MsgId messageId) {
 void SparseIdsList::removeAll() {
 	_slices.clear();
 	_slices.emplace(base::flat_set<MsgId>{}, MsgRange { 0, ServerMaxMsgId });
+	_unconfirmed.clear();
 	_count = 0;
 }
 
@@ -236,6 +272,113 @@ bool SparseIdsList::empty() const {
 	return true;
 }
 
+QByteArray SparseIdsList::serialize() const {
+	// Keep only the newest ids, older slices are requested on scroll.
+	auto slices = std::vector<not_null<const Slice*>>();
+	auto total = 0;
+	for (auto i = _slices.rbegin(); i != _slices.rend(); ++i) {
+		if (i->messages.empty()) {
+			continue;
+		}
+		slices.push_back(&*i);
+		total += int(i->messages.size());
+		if (total >= kMaxSerializedIds) {
+			break;
+		}
+	}
+	if (slices.empty()) {
+		return QByteArray();
+	}
+	const auto skip = std::max(total - kMaxSerializedIds, 0);
+	auto result = QByteArray();
+	result.reserve(int(sizeof(qint32)) * (2 + 3 * int(slices.size()) + total));
+	{
+		auto stream = QDataStream(&result, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream << kSerializeVersion << qint32(slices.size());
+		for (const auto slice : slices) {
+			const auto from = (slice == slices.back()) ? skip : 0;
+			const auto &messages = slice->messages;
+			const auto first = messages.begin() + from;
+			stream
+				<< qint32(from ? *first : slice->range.from)
+				<< qint32(slice->range.till)
+				<< qint32(int(messages.end() - first));
+			for (auto i = first; i != messages.end(); ++i) {
+				stream << qint32(*i);
+			}
+		}
+	}
+	return result;
+}
+
+void SparseIdsList::restore(const QByteArray &serialized) {
+	auto stream = QDataStream(serialized);
+	stream.setVersion(QDataStream::Qt_5_1);
+	auto version = qint32();
+	auto count = qint32();
+	stream >> version >> count;
+	if (stream.status() != QDataStream::Ok
+		|| version != kSerializeVersion
+		|| count <= 0
+		|| count > kMaxSerializedIds) {
+		return;
+	}
+	auto slices = std::vector<std::pair<std::vector<MsgId>, MsgRange>>();
+	slices.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		auto from = qint32();
+		auto till = qint32();
+		auto size = qint32();
+		stream >> from >> till >> size;
+		if (stream.status() != QDataStream::Ok
+			|| from < 0
+			|| till < from
+			|| till > ServerMaxMsgId
+			|| size <= 0
+			|| size > kMaxSerializedIds) {
+			return;
+		}
+		auto ids = std::vector<MsgId>();
+		ids.reserve(size);
+		for (auto j = 0; j != size; ++j) {
+			auto id = qint32();
+			stream >> id;
+			ids.push_back(id);
+		}
+		if (stream.status() != QDataStream::Ok
+			|| !ranges::is_sorted(ids)
+			|| ids.front() < from
+			|| ids.back() > till) {
+			return;
+		}
+
+		// New messages could have arrived since, ask for them again.
+		if (till == ServerMaxMsgId) {
+			till = ids.back();
+		}
+		slices.emplace_back(std::move(ids), MsgRange{ from, till });
+	}
+	for (auto &[ids, range] : slices) {
+		// Ranges already received from the server are more recent.
+		ids.erase(ranges::remove_if(ids, [&](MsgId id) {
+			const auto slice = ranges::lower_bound(
+				_slices,
+				id,
+				std::less<>(),
+				[](const Slice &slice) { return slice.range.till; });
+			if (slice == _slices.end() || slice->range.from > id) {
+				_unconfirmed.emplace(id);
+				return false;
+			}
+			return !slice->messages.contains(id);
+		}), end(ids));
+		if (!ids.empty()) {
+			addRange(ids, range, std::nullopt);
+		}
+	}
+}
+
 rpl::producer<SparseIdsSliceUpdate> SparseIdsList::sliceUpdated() const {
 	return _sliceUpdated.events();
 }
@@ -54,6 +54,10 @@ public:
 	SparseIdsListResult snapshot(const SparseIdsListQuery &query) const;
 	bool empty() const;
 
+	// Known slices without the total count, which is always requested again.
+	[[nodiscard]] QByteArray serialize() const;
+	void restore(const QByteArray &serialized);
+
 private:
 	struct Slice {
 		Slice(base::flat_set<MsgId> &&messages, MsgRange range);
@@ -91,6 +95,9 @@ private:
 		MsgRange noSkipRange,
 		std::optional<int> count,
 		bool incrementCount = false);
+	template <typename Range>
+	void confirmRange(const Range &messages, MsgRange noSkipRange);
+	void removeFromSlices(MsgId messageId);
 
 	SparseIdsListResult queryFromSlice(
 		const SparseIdsListQuery &query,
@@ -99,6 +106,9 @@ private:
 	std::optional<int> _count;
 	base::flat_set<Slice> _slices;
 
+	// Restored from the local cache and not yet received from the server.
+	base::flat_set<MsgId> _unconfirmed;
+
 	rpl::event_stream<SparseIdsSliceUpdate> _sliceUpdated;
 
 };
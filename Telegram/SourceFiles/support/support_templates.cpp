@@ -20,6 +20,18 @@ namespace {
 
 constexpr auto kQueryLimit = 10;
 constexpr auto kWeightStep = 1000;
+constexpr auto kTypoMinLength = 4;
+
+// BM25 parameters.
+constexpr auto kTermFrequencySaturation = 1.2;
+constexpr auto kLengthNormalization = 0.75;
+
+enum class TermMatch {
+	None,
+	Typo,
+	Prefix,
+	Exact,
+};
 
 struct Delta {
 	std::vector<const TemplatesQuestion*> added;
@@ -271,75 +283,87 @@ FilesResult ReadFiles(const QString &folder) {
 }
 
 TemplatesIndex ComputeIndex(const TemplatesData &data) {
-	using Id = TemplatesIndex::Id;
-	using Term = TemplatesIndex::Term;
+	using Posting = TemplatesIndex::Posting;
 
-	auto uniqueFirst = std::map<QChar, base::flat_set<Id>>();
-	auto uniqueFull = std::map<Id, base::flat_set<Term>>();
-	const auto pushString = [&](
-			const Id &id,
-			const QString &string,
-			int weight) {
-		const auto list = TextUtilities::PrepareSearchWords(string);
-		for (const auto &word : list) {
-			uniqueFirst[word[0]].emplace(id);
-			uniqueFull[id].emplace(std::make_pair(word, weight));
-		}
-	};
+	auto result = TemplatesIndex();
+	auto postings = std::map<QString, std::vector<Posting>>();
+	auto counted = base::flat_map<QString, Posting>();
+	auto totalLength = int64(0);
 	for (const auto &[path, file] : data.files) {
 		for (const auto &[normalized, question] : file.questions) {
-			const auto id = std::make_pair(path, normalized);
+			const auto index = int(result.ids.size());
+			auto length = 0;
+			const auto pushString = [&](const QString &string, int weight) {
+				const auto list = TextUtilities::PrepareSearchWords(string);
+				for (const auto &word : list) {
+					auto &posting = counted[word];
+					posting.question = index;
+					accumulate_max(posting.weight, weight);
+					++posting.count;
+					++length;
+				}
+			};
 			for (const auto &key : question.normalizedKeys) {
-				pushString(id, key, kWeightStep * kWeightStep);
+				pushString(key, kWeightStep * kWeightStep);
+			}
+			pushString(question.question, kWeightStep);
+			pushString(question.value, 1);
+
+			result.ids.push_back(std::make_pair(path, normalized));
+			result.lengths.push_back(length);
+			totalLength += length;
+			for (const auto &[word, posting] : counted) {
+				postings[word].push_back(posting);
 			}
-			pushString(id, question.question, kWeightStep);
-			pushString(id, question.value, 1);
+			counted.clear();
 		}
 	}
-
-	auto result = TemplatesIndex();
-	for (const auto &[ch, unique] : uniqueFirst) {
-		result.first.emplace(ch, unique | ranges::to_vector);
-	}
-	for (const auto &[id, unique] : uniqueFull) {
-		result.full.emplace(id, unique | ranges::to_vector);
+	result.terms.reserve(postings.size());
+	for (auto &[word, list] : postings) {
+		result.terms.emplace_back(word, std::move(list));
 	}
+	result.averageLength = result.ids.empty()
+		? 0.
+		: (double(totalLength) / result.ids.size());
 	return result;
 }
 
-void ReplaceFileIndex(
-		TemplatesIndex &result,
-		TemplatesIndex &&source,
-		const QString &path) {
-	for (auto i = begin(result.full); i != end(result.full);) {
-		if (i->first.first == path) {
-			i = result.full.erase(i);
-		} else {
-			++i;
-		}
+TermMatch MatchTerm(const QString &word, const QString &term) {
+	const auto size = word.size();
+	const auto full = term.size();
+	auto i = 0;
+	while (i != size && i != full && word[i] == term[i]) {
+		++i;
 	}
-	for (auto &[id, list] : source.full) {
-		result.full.emplace(id, std::move(list));
+	if (i == size) {
+		return (i == full) ? TermMatch::Exact : TermMatch::Prefix;
+	} else if (size < kTypoMinLength) {
+		return TermMatch::None;
 	}
 
-	using Id = TemplatesIndex::Id;
-	for (auto &[ch, list] : result.first) {
-		auto i = ranges::lower_bound(
-			list,
-			std::make_pair(path, QString()));
-		auto j = std::find_if(i, end(list), [&](const Id &id) {
-			return id.first != path;
-		});
-		list.erase(i, j);
-	}
-	for (auto &[ch, list] : source.first) {
-		auto &to = result.first[ch];
-		to.insert(
-			end(to),
-			std::make_move_iterator(begin(list)),
-			std::make_move_iterator(end(list)));
-		ranges::sort(to);
-	}
+	// Allow one typo: the rest of the word from 'from' should be
+	// a prefix of the rest of the term from 'to'.
+	const auto restMatches = [&](int from, int to) {
+		if (size - from > full - to) {
+			return false;
+		}
+		for (; from != size; ++from, ++to) {
+			if (word[from] != term[to]) {
+				return false;
+			}
+		}
+		return true;
+	};
+	const auto transposed = (i + 1 < size)
+		&& (i + 1 < full)
+		&& (word[i] == term[i + 1])
+		&& (word[i + 1] == term[i]);
+	return (restMatches(i + 1, i + 1) // Replaced.
+		|| restMatches(i, i + 1) // Missed.
+		|| restMatches(i + 1, i) // Inserted.
+		|| (transposed && restMatches(i + 2, i + 2)))
+		? TermMatch::Typo
+		: TermMatch::None;
 }
 
 void MoveKeys(TemplatesFile &to, const TemplatesFile &from) {
@@ -492,6 +516,7 @@ void Templates::load() {
 		]() mutable {
 			setData(std::move(result.result));
 			_index = std::move(result.index);
+			_indexing = base::binary_guard();
 			_errors.fire(std::move(result.errors));
 			crl::on_main(this, [=] {
 				if (base::take(_reloadAfterRead)) {
@@ -504,6 +529,17 @@ void Templates::load() {
 	});
 }
 
+void Templates::reindex() {
+	// Keep querying the previous index until the new one is ready.
+	crl::async([=, data = _data, guard = _indexing.make_guard()]() mutable {
+		auto index = ComputeIndex(data);
+		crl::on_main(std::move(guard), [=, index = std::move(index)](
+				) mutable {
+			_index = std::move(index);
+		});
+	});
+}
+
 void Templates::setData(TemplatesData &&data) {
 	_data = std::move(data);
 	_maxKeyLength = CountMaxKeyLength(_data);
@@ -570,17 +606,14 @@ void Templates::updateRequestFinished(QNetworkReply *reply) {
 		auto result = ReadFromBlob(content);
 		auto one = TemplatesData();
 		one.files.emplace(path, std::move(result.result));
-		auto index = ComputeIndex(one);
 		crl::on_main(weak,[
 			=,
 			one = std::move(one),
-			errors = std::move(result.errors),
-			index = std::move(index)
+			errors = std::move(result.errors)
 		]() mutable {
 			auto &existing = _data.files.at(path);
 			auto &parsed = one.files.at(path);
 			MoveKeys(parsed, existing);
-			ReplaceFileIndex(_index, ComputeIndex(one), path);
 			if (!errors.isEmpty()) {
 				_errors.fire(std::move(errors));
 			}
@@ -597,6 +630,7 @@ void Templates::updateRequestFinished(QNetworkReply *reply) {
 				_session->data().serviceNotification({ full });
 			}
 			_data.files.at(path) = std::move(one.files.at(path));
+			reindex();
 
 			_updates->requests.erase(path);
 			checkUpdateFinished();
@@ -666,78 +700,120 @@ Templates::~Templates() = default;
 
 auto Templates::query(const QString &text) const -> std::vector<Question> {
 	const auto words = TextUtilities::PrepareSearchWords(text);
-	const auto questions = [&](const QString &word) {
-		const auto i = _index.first.find(word[0]);
-		return (i == end(_index.first)) ? 0 : i->second.size();
-	};
-	const auto best = ranges::min_element(words, std::less<>(), questions);
-	if (best == std::end(words)) {
-		return {};
-	}
-	const auto narrowed = _index.first.find((*best)[0]);
-	if (narrowed == end(_index.first)) {
+	const auto count = int(_index.ids.size());
+	if (words.isEmpty() || !count) {
 		return {};
 	}
-	using Id = TemplatesIndex::Id;
 	using Term = TemplatesIndex::Term;
-	const auto questionById = [&](const Id &id) {
-		return _data.files.at(id.first).questions.at(id.second);
+	const auto &terms = _index.terms;
+	const auto termWeight = [&](const Term &term, TermMatch match) {
+		const auto found = double(term.second.size());
+		const auto idf = std::log(1. + (count - found + 0.5) / (found + 0.5));
+		switch (match) {
+		case TermMatch::Exact: return 4. * idf;
+		case TermMatch::Prefix: return 2. * idf;
+		case TermMatch::Typo: return idf;
+		}
+		return 0.;
 	};
 
-	const auto computeWeight = [&](const Id &id) {
-		auto result = 0;
-		const auto full = _index.full.find(id);
-		for (const auto &word : words) {
+	// BM25 over all the fields, scaled by the best field weight,
+	// so that keys still go before questions and questions before values.
+	auto scores = std::vector<double>(count, 0.);
+	auto matched = std::vector<int>(count, 0);
+	auto best = std::vector<double>(count, 0.);
+	const auto apply = [&](const Term &term, TermMatch match) {
+		const auto weight = termWeight(term, match);
+		for (const auto &posting : term.second) {
+			const auto length = _index.lengths[posting.question];
+			const auto frequency = double(posting.count);
+			const auto normalized = frequency
+				* (kTermFrequencySaturation + 1.)
+				/ (frequency + kTermFrequencySaturation
+					* (1. - kLengthNormalization
+						+ kLengthNormalization
+						* length
+						/ _index.averageLength));
+			accumulate_max(
+				best[posting.question],
+				posting.weight * weight * normalized);
+		}
+	};
+	for (const auto &word : words) {
+		ranges::fill(best, 0.);
+		if (word.size() < kTypoMinLength) {
 			const auto from = ranges::lower_bound(
-				full->second,
+				terms,
 				word,
 				std::less<>(),
-				[](const Term &term) { return term.first; });
-			const auto till = std::find_if(
-				from,
-				end(full->second),
-				[&](const Term &term) {
-					return !term.first.startsWith(word);
-				});
-			const auto weight = std::max_element(
-				from,
-				till,
-				[](const Term &a, const Term &b) {
-					return a.second < b.second;
-				});
-			if (weight == till) {
-				return 0;
+				&Term::first);
+			for (auto i = from; i != end(terms); ++i) {
+				const auto match = MatchTerm(word, i->first);
+				if (match == TermMatch::None) {
+					break;
+				}
+				apply(*i, match);
+			}
+		} else {
+			// Typos may be anywhere, so check all the terms.
+			for (const auto &term : terms) {
+				const auto match = MatchTerm(word, term.first);
+				if (match != TermMatch::None) {
+					apply(term, match);
+				}
 			}
-			result += weight->second * (weight->first == word ? 2 : 1);
 		}
-		return result;
-	};
-	using Pair = std::pair<Id, int>;
-	const auto pairById = [&](const Id &id) {
-		return std::make_pair(id, computeWeight(id));
-	};
-	const auto sorter = [](const Pair &a, const Pair &b) {
+		for (auto i = 0; i != count; ++i) {
+			if (best[i] > 0.) {
+				scores[i] += best[i];
+				++matched[i];
+			}
+		}
+	}
+
+	using Pair = std::pair<int, double>;
+	const auto &ids = _index.ids;
+	const auto sorter = [&](const Pair &a, const Pair &b) {
 		// weight DESC filename DESC question ASC
+		const auto &aid = ids[a.first];
+		const auto &bid = ids[b.first];
 		if (a.second > b.second) {
 			return true;
 		} else if (a.second < b.second) {
 			return false;
-		} else if (a.first.first > b.first.first) {
+		} else if (aid.first > bid.first) {
 			return true;
-		} else if (a.first.first < b.first.first) {
+		} else if (aid.first < bid.first) {
 			return false;
 		} else {
-			return (a.first.second < b.first.second);
+			return (aid.second < bid.second);
 		}
 	};
-	const auto good = narrowed->second | ranges::views::transform(
-		pairById
-	) | ranges::views::filter([](const Pair &pair) {
-		return pair.second > 0;
-	}) | ranges::to_vector | ranges::actions::stable_sort(sorter);
-	return good | ranges::views::transform([&](const Pair &pair) {
-		return questionById(pair.first);
-	}) | ranges::views::take(kQueryLimit) | ranges::to_vector;
+	auto good = std::vector<Pair>();
+	for (auto i = 0; i != count; ++i) {
+		if (matched[i] == int(words.size())) {
+			good.emplace_back(i, scores[i]);
+		}
+	}
+	const auto take = std::min(int(good.size()), kQueryLimit);
+	ranges::partial_sort(good, begin(good) + take, sorter);
+
+	// The index may be a bit behind _data while reindex() is running.
+	auto result = std::vector<Question>();
+	result.reserve(take);
+	for (const auto &[index, score] : good | ranges::views::take(take)) {
+		const auto &[path, normalized] = ids[index];
+		const auto file = _data.files.find(path);
+		if (file == end(_data.files)) {
+			continue;
+		}
+		const auto &questions = file->second.questions;
+		const auto question = questions.find(normalized);
+		if (question != end(questions)) {
+			result.push_back(question->second);
+		}
+	}
+	return result;
 }
 
 } // namespace Support
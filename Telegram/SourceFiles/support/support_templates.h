@@ -34,12 +34,22 @@ struct TemplatesData {
 	std::map<QString, TemplatesFile> files;
 };
 
+// Sorted term dictionary with postings lists, so that all the terms
+// starting with a typed prefix form one contiguous range.
 struct TemplatesIndex {
 	using Id = std::pair<QString, QString>; // filename, normalized question
-	using Term = std::pair<QString, int>; // search term, weight
 
-	std::map<QChar, std::vector<Id>> first;
-	std::map<Id, std::vector<Term>> full;
+	struct Posting {
+		int question = 0; // index in ids
+		int weight = 0; // weight of the best field containing the term
+		int count = 0; // occurrences in all fields
+	};
+	using Term = std::pair<QString, std::vector<Posting>>;
+
+	std::vector<Id> ids;
+	std::vector<int> lengths; // words count for each of ids
+	std::vector<Term> terms;
+	double averageLength = 0.;
 };
 
 } // namespace details
@@ -73,6 +83,7 @@ private:
 	struct Updates;
 
 	void load();
+	void reindex();
 	void update();
 	void ensureUpdatesCreated();
 	void updateRequestFinished(QNetworkReply *reply);
@@ -85,6 +96,7 @@ private:
 	details::TemplatesIndex _index;
 	rpl::event_stream<QStringList> _errors;
 	base::binary_guard _reading;
+	base::binary_guard _indexing;
 	bool _reloadAfterRead = false;
 	rpl::lifetime _reloadToastSubscription;
 
@@ -13,6 +13,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtp_instance.h"
 #include "mtproto/facade.h"
 #include "main/main_account.h"
+#include "main/main_session.h"
+#include "api/api_updates.h"
 #include "core/application.h"
 #include "core/core_settings.h"
 #include "core/update_checker.h"
@@ -233,6 +235,17 @@ ConnectionState::ConnectionState(
 	) | rpl::start_with_next([=] {
 		refreshState();
 	}, _lifetime);
+
+	_account->sessionValue(
+	) | rpl::map([=](Main::Session *session) {
+		return session
+			? session->updates().catchingUpValue()
+			: rpl::single(false);
+	}) | rpl::flatten_latest(
+	) | rpl::start_with_next([=](bool catchingUp) {
+		_catchingUp = catchingUp;
+		refreshState();
+	}, _lifetime);
 }
 
 void ConnectionState::createWidget() {
@@ -299,6 +312,8 @@ void ConnectionState::refreshState() {
 		} else if (state < 0) {
 			const auto wait = ((-state) / 1000) + 1;
 			return { State::Type::Waiting, proxy, under, ready, wait };
+		} else if (_catchingUp) {
+			return { State::Type::Updating, proxy, under, ready };
 		}
 		return { State::Type::Connected, proxy, under, ready };
 	}();
@@ -418,7 +433,8 @@ auto ConnectionState::computeLayout(const State &state) const -> Layout {
 	result.visible = !state.updateReady
 		&& (state.useProxy
 			|| state.type == State::Type::Connecting
-			|| state.type == State::Type::Waiting);
+			|| state.type == State::Type::Waiting
+			|| state.type == State::Type::Updating);
 	switch (state.type) {
 	case State::Type::Connecting:
 		result.text = state.underCursor
@@ -426,6 +442,12 @@ auto ConnectionState::computeLayout(const State &state) const -> Layout {
 			: QString();
 		break;
 
+	case State::Type::Updating:
+		result.text = state.underCursor
+			? tr::lng_updating(tr::now)
+			: QString();
+		break;
+
 	case State::Type::Waiting:
 		Assert(state.waitTillRetry > 0);
 		result.text = tr::lng_reconnecting(
@@ -42,6 +42,7 @@ private:
 			Connected,
 			Connecting,
 			Waiting,
+			Updating,
 		};
 		Type type = Type::Connected;
 		bool useProxy = false;
@@ -84,6 +85,7 @@ private:
 	State _state;
 	Layout _currentLayout;
 	crl::time _connectingStartedAt = 0;
+	bool _catchingUp = false;
 	Ui::Animations::Simple _contentWidth;
 	Ui::Animations::Simple _visibility;
 
@@ -34,7 +34,7 @@ namespace {
 [[nodiscard]] rpl::producer<Dialogs::UnreadState> MainListUnreadState(
 		not_null<Dialogs::MainList*> list) {
 	return rpl::single(rpl::empty_value()) | rpl::then(
-		list->unreadStateChanges() | rpl::to_empty
+		list->unreadStateUpdates()
 	) | rpl::map([=] {
 		return list->unreadState();
 	});